@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    AllocationTripwire.cpp
+
+  ==============================================================================
+*/
+
+#include "AllocationTripwire.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace AllocationTripwire
+{
+    namespace
+    {
+        thread_local bool isRealtimeThread = false;
+        thread_local juce::int64 numRealtimeAllocations = 0;
+
+        std::atomic<bool> assertOnAllocation{ true };
+    }
+
+    ScopedRealtimeSection::ScopedRealtimeSection() noexcept
+        : wasRealtime(isRealtimeThread)
+    {
+        isRealtimeThread = isEnabled;
+    }
+
+    ScopedRealtimeSection::~ScopedRealtimeSection() noexcept
+    {
+        isRealtimeThread = wasRealtime;
+    }
+
+    juce::int64 getNumRealtimeAllocationsOnThisThread() noexcept
+    {
+        return numRealtimeAllocations;
+    }
+
+    void setAssertOnAllocation(bool shouldAssert) noexcept
+    {
+        assertOnAllocation.store(shouldAssert);
+    }
+
+   #if FEATHERING_ALLOCATION_TRIPWIRE
+    static void* allocate(std::size_t size)
+    {
+        if (isRealtimeThread)
+        {
+            ++numRealtimeAllocations;
+
+            if (assertOnAllocation.load(std::memory_order_relaxed))
+            {
+                // Logging the assertion allocates too, so step out of the section while it fires
+                isRealtimeThread = false;
+                jassertfalse;   // Something allocated on the audio thread: check the call stack
+                isRealtimeThread = true;
+            }
+        }
+
+        if (auto* ptr = std::malloc(size > 0 ? size : 1))
+            return ptr;
+
+        throw std::bad_alloc();
+    }
+   #endif
+}
+
+#if FEATHERING_ALLOCATION_TRIPWIRE
+void* operator new(std::size_t size)                    { return AllocationTripwire::allocate(size); }
+void* operator new[](std::size_t size)                  { return AllocationTripwire::allocate(size); }
+void operator delete(void* ptr) noexcept                { std::free(ptr); }
+void operator delete[](void* ptr) noexcept              { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept   { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    AllocationTripwire.h
+
+    Watches for heap allocations on real-time threads. When enabled, the
+    global operator new is replaced with one that counts allocations made
+    inside a ScopedRealtimeSection, and can assert on them, so an allocation
+    sneaking into processBlock shows up the first time it happens rather
+    than as an occasional dropout in a big session.
+
+    Enabled by default in debug builds. Define FEATHERING_ALLOCATION_TRIPWIRE
+    to 1 or 0 to override; the tools build turns it on to count allocations
+    in release builds.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef FEATHERING_ALLOCATION_TRIPWIRE
+ #if JUCE_DEBUG
+  #define FEATHERING_ALLOCATION_TRIPWIRE 1
+ #else
+  #define FEATHERING_ALLOCATION_TRIPWIRE 0
+ #endif
+#endif
+
+namespace AllocationTripwire
+{
+    constexpr bool isEnabled = FEATHERING_ALLOCATION_TRIPWIRE != 0;
+
+    // Marks the calling thread as real-time for the lifetime of the object. Sections may nest.
+    class ScopedRealtimeSection
+    {
+    public:
+        ScopedRealtimeSection() noexcept;
+        ~ScopedRealtimeSection() noexcept;
+
+    private:
+        bool wasRealtime;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeSection)
+    };
+
+    // Allocations made so far inside real-time sections on the calling thread. Always 0 when disabled.
+    juce::int64 getNumRealtimeAllocationsOnThisThread() noexcept;
+
+    // Whether an allocation in a real-time section trips a jassert. On by default; the benchmark
+    // turns it off because it wants the count rather than a break.
+    void setAssertOnAllocation(bool shouldAssert) noexcept;
+}
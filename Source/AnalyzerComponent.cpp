@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    AnalyzerComponent.cpp
+
+  ==============================================================================
+*/
+
+#include "AnalyzerComponent.h"
+
+AnalyzerComponent::AnalyzerComponent(SpectrumAnalyzer& analyzerToUse, PerformanceMonitor& monitorToUse, ResponseCurveBase& curveToUse)
+    : analyzer(analyzerToUse),
+      monitor(monitorToUse),
+      responseCurve(curveToUse)
+{
+    setOpaque(true);
+
+    analyzer.setActive(true);
+    startTimerHz(framesPerSecond);
+}
+
+AnalyzerComponent::~AnalyzerComponent()
+{
+    analyzer.setActive(false);
+}
+
+void AnalyzerComponent::paint(juce::Graphics& g)
+{
+    g.drawImageAt(grid, 0, 0);
+
+    g.setColour(juce::Colours::skyblue.withAlpha(0.25f));
+    g.fillPath(prePath);
+
+    g.setColour(juce::Colours::orange);
+    g.strokePath(postPath, juce::PathStrokeType(1.5f));
+
+    g.setColour(juce::Colours::white);
+    g.strokePath(responsePath, juce::PathStrokeType(2.f));
+
+    g.setColour(juce::Colours::white.withAlpha(0.7f));
+    g.setFont(12.f);
+    g.drawText(loadText, getLocalBounds().reduced(6), juce::Justification::topRight);
+}
+
+void AnalyzerComponent::resized()
+{
+    analyzer.setDisplaySize(getWidth(), getHeight());
+    responseCurve.setNumPoints(getWidth());
+    renderGrid();
+}
+
+void AnalyzerComponent::timerCallback()
+{
+    auto hasNewFrame = analyzer.getLatestPath(SpectrumAnalyzer::pre, prePath);
+    hasNewFrame = analyzer.getLatestPath(SpectrumAnalyzer::post, postPath) || hasNewFrame;
+
+    // The curve only changes when a band does, so the path is rebuilt only then
+    if (responseCurve.getLatestCurve(responseDecibels))
+    {
+        updateResponsePath();
+        hasNewFrame = true;
+    }
+
+    // The load readout only needs to change a couple of times a second
+    if (--framesUntilLoadUpdate <= 0)
+    {
+        framesUntilLoadUpdate = framesPerSecond / 2;
+
+        auto snapshot = monitor.getSnapshot();
+        loadText = "CPU " + juce::String(snapshot.averageLoad * 100.f, 1) + "%"
+                 + (snapshot.numOverruns > 0 ? ", overruns " + juce::String(snapshot.numOverruns) : juce::String());
+
+        hasNewFrame = true;
+    }
+
+    if (hasNewFrame)
+        repaint();
+}
+
+void AnalyzerComponent::renderGrid()
+{
+    auto width = juce::jmax(1, getWidth());
+    auto height = juce::jmax(1, getHeight());
+
+    grid = juce::Image(juce::Image::RGB, width, height, true);
+    juce::Graphics g(grid);
+
+    g.fillAll(juce::Colour(0xff15181c));
+    g.setFont(10.f);
+
+    for (auto frequency : { 50.f, 100.f, 200.f, 500.f, 1000.f, 2000.f, 5000.f, 10000.f })
+    {
+        auto x = SpectrumAnalyzer::frequencyToX(frequency, (float) width);
+
+        g.setColour(juce::Colours::white.withAlpha(0.1f));
+        g.drawVerticalLine(juce::roundToInt(x), 0.f, (float) height);
+
+        g.setColour(juce::Colours::white.withAlpha(0.4f));
+        g.drawText(frequency >= 1000.f ? juce::String(frequency / 1000.f) + "k" : juce::String((int) frequency),
+                   juce::roundToInt(x) + 2, height - 14, 40, 12, juce::Justification::left);
+    }
+
+    for (auto decibels = SpectrumAnalyzer::maxDecibels; decibels > SpectrumAnalyzer::minDecibels; decibels -= 12.f)
+    {
+        auto y = SpectrumAnalyzer::decibelsToY(decibels, (float) height);
+
+        g.setColour(juce::Colours::white.withAlpha(decibels == 0.f ? 0.25f : 0.1f));
+        g.drawHorizontalLine(juce::roundToInt(y), 0.f, (float) width);
+
+        g.setColour(juce::Colours::white.withAlpha(0.4f));
+        g.drawText(juce::String((int) decibels) + " dB", 4, juce::roundToInt(y) + 1, 50, 12, juce::Justification::left);
+    }
+}
+
+void AnalyzerComponent::updateResponsePath()
+{
+    auto height = (float) getHeight();
+
+    responsePath.clear();
+
+    for (size_t i = 0; i < responseDecibels.size(); ++i)
+    {
+        auto y = juce::jmap(juce::jlimit(-curveRangeDecibels, curveRangeDecibels, responseDecibels[i]),
+                            -curveRangeDecibels, curveRangeDecibels, height, 0.f);
+
+        if (i == 0)
+            responsePath.startNewSubPath(0.f, y);
+        else
+            responsePath.lineTo((float) i, y);
+    }
+}
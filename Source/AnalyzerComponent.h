@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    AnalyzerComponent.h
+
+    Draws the SpectrumAnalyzer's pre and post spectra over a cached grid,
+    the bands' combined response curve on top, and the instance's CPU load
+    from the PerformanceMonitor in the corner. Its timer runs at a fixed
+    frame rate and only repaints when a new spectrum or curve has arrived,
+    and the spectra arrive ready-built, so a paint is a grid blit, a fill
+    and a stroke.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyzer.h"
+#include "PerformanceMonitor.h"
+#include "ResponseCurve.h"
+
+class AnalyzerComponent  : public juce::Component,
+                           private juce::Timer
+{
+public:
+    static constexpr int framesPerSecond = 30;
+
+    // The response curve's scale: +/- this many dB over the full height
+    static constexpr float curveRangeDecibels = 24.f;
+
+    AnalyzerComponent(SpectrumAnalyzer& analyzerToUse, PerformanceMonitor& monitorToUse, ResponseCurveBase& curveToUse);
+    ~AnalyzerComponent() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+    void renderGrid();
+    void updateResponsePath();
+
+    SpectrumAnalyzer& analyzer;
+    PerformanceMonitor& monitor;
+    ResponseCurveBase& responseCurve;
+
+    juce::Path prePath, postPath, responsePath;
+    std::vector<float> responseDecibels;
+    juce::Image grid;
+    juce::String loadText;
+    int framesUntilLoadUpdate{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalyzerComponent)
+};
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    BackgroundThread.h
+
+    One low-priority worker thread shared by every plugin instance in the
+    process (via juce::SharedResourcePointer), for non-realtime jobs such as
+    kernel rebuilds. Sharing it keeps a session with hundreds of instances
+    from spawning hundreds of threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SharedBackgroundThread  : public juce::TimeSliceThread
+{
+public:
+    SharedBackgroundThread()
+        : juce::TimeSliceThread("Feathering background worker")
+    {
+        startThread();
+    }
+
+    ~SharedBackgroundThread() override
+    {
+        stopThread(2000);
+    }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedBackgroundThread)
+};
@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    BandDynamics.h
+
+    Level detection for dynamic bands. Each dynamic band listens to the
+    input through its own unity-peak band-pass (an SVF at the band's
+    frequency and Q) and accumulates the energy it lets through. Detector
+    data is struct-of-arrays over a dense list of the dynamic bands, so the
+    per-sample loop runs across bands and the compiler vectorises it.
+
+    Once per control tick the energy becomes a level in dB, which an
+    attack/release follower smooths and a threshold and ratio turn into how
+    far the band's gain should go towards its set value.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+template <int NumBands>
+class DynamicsDetector
+{
+public:
+    DynamicsDetector() = default;
+
+    // Attack and release are per control tick, as one-pole coefficients
+    void setTimes(double ticksPerSecond, float attackMs, float releaseMs) noexcept
+    {
+        auto getCoefficient = [ticksPerSecond](float ms)
+        {
+            return (float) (1.0 - std::exp(-1.0 / (juce::jmax(0.01, (double) ms * 1.0e-3) * ticksPerSecond)));
+        };
+
+        attackCoefficient = getCoefficient(attackMs);
+        releaseCoefficient = getCoefficient(releaseMs);
+    }
+
+    void reset() noexcept
+    {
+        for (int slot = 0; slot < numSlots; ++slot)
+        {
+            ic1eq[(size_t) slot] = ic2eq[(size_t) slot] = energy[(size_t) slot] = 0.f;
+            envelopeDecibels[(size_t) slot] = silenceDecibels;
+        }
+
+        numAccumulated = 0;
+    }
+
+    int getNumBands() const noexcept  { return numSlots; }
+    int getBand(int slot) const noexcept  { return slotBands[(size_t) slot]; }
+
+    // Sets which bands are dynamic, in ascending order. Bands that stay dynamic keep their
+    // detector and envelope; new ones start from silence.
+    void setBands(const int* bands, int numBands) noexcept
+    {
+        auto oldBands = slotBands;
+        auto oldNumSlots = numSlots;
+        auto oldIc1eq = ic1eq, oldIc2eq = ic2eq, oldEnergy = energy, oldEnvelope = envelopeDecibels;
+
+        numSlots = numBands;
+
+        for (int slot = 0, oldSlot = 0; slot < numSlots; ++slot)
+        {
+            auto band = bands[slot];
+            slotBands[(size_t) slot] = band;
+
+            while (oldSlot < oldNumSlots && oldBands[(size_t) oldSlot] < band)
+                ++oldSlot;
+
+            auto kept = oldSlot < oldNumSlots && oldBands[(size_t) oldSlot] == band;
+            auto from = (size_t) oldSlot;
+
+            ic1eq[(size_t) slot] = kept ? oldIc1eq[from] : 0.f;
+            ic2eq[(size_t) slot] = kept ? oldIc2eq[from] : 0.f;
+            energy[(size_t) slot] = kept ? oldEnergy[from] : 0.f;
+            envelopeDecibels[(size_t) slot] = kept ? oldEnvelope[from] : silenceDecibels;
+        }
+    }
+
+    // The slot's band-pass, from its prewarped frequency and Q, and its gain computer
+    void setBand(int slot, double g, float quality, float thresholdInDecibels, float ratio) noexcept
+    {
+        auto k = 1.0 / quality;
+        auto a1 = 1.0 / (1.0 + g * (g + k));
+
+        a1s[(size_t) slot] = (float) a1;
+        a2s[(size_t) slot] = (float) (g * a1);
+        a3s[(size_t) slot] = (float) (g * g * a1);
+        ks[(size_t) slot] = (float) k;
+
+        thresholds[(size_t) slot] = thresholdInDecibels;
+        slopes[(size_t) slot] = 1.f - 1.f / juce::jmax(1.f, ratio);
+    }
+
+    // Runs every dynamic band's band-pass over the mono sidechain, accumulating energy. The
+    // detectors run in float whatever the audio precision; a level needs no more.
+    template <typename SampleType>
+    void accumulate(const SampleType* sidechain, int numSamples) noexcept
+    {
+        auto* a1 = a1s.data();
+        auto* a2 = a2s.data();
+        auto* a3 = a3s.data();
+        auto* k = ks.data();
+        auto* s1 = ic1eq.data();
+        auto* s2 = ic2eq.data();
+        auto* e = energy.data();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = (float) sidechain[i];
+
+            // Independent across slots, so this loop vectorises
+            for (int slot = 0; slot < numSlots; ++slot)
+            {
+                auto v3 = x - s2[slot];
+                auto v1 = a1[slot] * s1[slot] + a2[slot] * v3;
+                auto v2 = s2[slot] + a2[slot] * s1[slot] + a3[slot] * v3;
+
+                s1[slot] = 2.f * v1 - s1[slot];
+                s2[slot] = 2.f * v2 - s2[slot];
+
+                auto bandpass = k[slot] * v1;
+                e[slot] += bandpass * bandpass;
+            }
+        }
+
+        numAccumulated += numSamples;
+    }
+
+    // Control tick: turns the energy since the last tick into how many dB each dynamic band
+    // should move by, calls moveBand(band, decibels), and starts accumulating afresh.
+    template <typename Callback>
+    void update(Callback&& moveBand) noexcept
+    {
+        if (numAccumulated == 0)
+            return;
+
+        auto normaliser = 1.f / (float) numAccumulated;
+        numAccumulated = 0;
+
+        for (int slot = 0; slot < numSlots; ++slot)
+        {
+            auto meanSquare = energy[(size_t) slot] * normaliser;
+            energy[(size_t) slot] = 0.f;
+
+            auto level = 10.f * std::log10(meanSquare + 1.0e-12f);
+            auto& envelope = envelopeDecibels[(size_t) slot];
+            envelope += (level > envelope ? attackCoefficient : releaseCoefficient) * (level - envelope);
+
+            auto over = envelope - thresholds[(size_t) slot];
+            moveBand(slotBands[(size_t) slot], over > 0.f ? over * slopes[(size_t) slot] : 0.f);
+        }
+    }
+
+private:
+    static constexpr float silenceDecibels = -120.f;
+
+    std::array<int, (size_t) NumBands> slotBands{};
+    int numSlots{ 0 }, numAccumulated{ 0 };
+
+    std::array<float, (size_t) NumBands> a1s{}, a2s{}, a3s{}, ks{};
+    std::array<float, (size_t) NumBands> thresholds{}, slopes{};
+    std::array<float, (size_t) NumBands> ic1eq{}, ic2eq{}, energy{}, envelopeDecibels{};
+
+    float attackCoefficient{ 1.f }, releaseCoefficient{ 1.f };
+};
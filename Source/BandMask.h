@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    BandMask.h
+
+    A lock-free set of band flags sized from the band count, for handing
+    "this band changed" from any thread to the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_MSVC
+ #include <intrin.h>
+#endif
+
+inline int countTrailingZeros(juce::uint64 value) noexcept
+{
+    jassert(value != 0);
+
+   #if JUCE_MSVC
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (int) index;
+   #else
+    return __builtin_ctzll(value);
+   #endif
+}
+
+template <int NumBands>
+class AtomicBandMask
+{
+public:
+    AtomicBandMask() noexcept
+    {
+        clear();
+    }
+
+    void set(int band) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(band, NumBands));
+        words[(size_t) (band / 64)].fetch_or(juce::uint64(1) << (band % 64));
+    }
+
+    void setAll() noexcept
+    {
+        for (int word = 0; word < numWords; ++word)
+        {
+            auto bandsInWord = juce::jmin(64, NumBands - word * 64);
+            words[(size_t) word].store(bandsInWord == 64 ? ~juce::uint64(0) : (juce::uint64(1) << bandsInWord) - 1);
+        }
+    }
+
+    void clear() noexcept
+    {
+        for (auto& word : words)
+            word.store(0);
+    }
+
+    // Clears the mask and calls fn(band) for every band that was set, in ascending order.
+    // Cost is proportional to the number of set bands, not to NumBands.
+    template <typename Fn>
+    int consume(Fn&& fn) noexcept
+    {
+        int numConsumed = 0;
+
+        for (int word = 0; word < numWords; ++word)
+        {
+            auto bits = words[(size_t) word].exchange(0);
+
+            while (bits != 0)
+            {
+                fn(word * 64 + countTrailingZeros(bits));
+                bits &= bits - 1;
+                ++numConsumed;
+            }
+        }
+
+        return numConsumed;
+    }
+
+private:
+    static constexpr int numWords = (NumBands + 63) / 64;
+
+    std::array<std::atomic<juce::uint64>, (size_t) numWords> words;
+};
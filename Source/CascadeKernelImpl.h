@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    CascadeKernelImpl.h
+
+    The lane-generic cascade kernel, shared by the per-ISA translation units.
+    Lanes supplies the sample and vector types plus load/store/arithmetic
+    for one ISA.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CascadeKernels.h"
+
+namespace Cascade
+{
+    // One SVF section held in registers. The update is written directly in the state variables:
+    //   ic1' = (2a1 - 1) ic1 - 2a2 ic2 + 2a2 v0
+    //   ic2' = 2a2 ic1 + (1 - 2a3) ic2 + 2a3 v0
+    // with v1 = (ic1 + ic1') / 2 and v2 = (ic2 + ic2') / 2. It's the same filter as the textbook
+    // form, but the sample-to-sample dependency is one multiply and two adds instead of six ops.
+    template <typename Lanes>
+    struct SectionRegisters
+    {
+        using Sample = typename Lanes::Sample;
+        using Vector = typename Lanes::Vector;
+
+        Vector k11, k22, twoA2, twoA3, m0, halfM1, halfM2;
+        Vector ic1eq, ic2eq;
+
+        void load(const LaneCoefficients<Sample>& c, const LaneState<Sample>& s) noexcept
+        {
+            const auto half = Lanes::broadcast((Sample) 0.5);
+            const auto two = Lanes::broadcast((Sample) 2);
+            const auto one = Lanes::broadcast((Sample) 1);
+
+            twoA2 = Lanes::mul(two, Lanes::load(c.a2));
+            twoA3 = Lanes::mul(two, Lanes::load(c.a3));
+            k11 = Lanes::sub(Lanes::mul(two, Lanes::load(c.a1)), one);
+            k22 = Lanes::sub(one, twoA3);
+            m0 = Lanes::load(c.m0);
+            halfM1 = Lanes::mul(half, Lanes::load(c.m1));
+            halfM2 = Lanes::mul(half, Lanes::load(c.m2));
+
+            ic1eq = Lanes::load(s.ic1eq);
+            ic2eq = Lanes::load(s.ic2eq);
+        }
+
+        void save(LaneState<Sample>& s) const noexcept
+        {
+            Lanes::store(s.ic1eq, ic1eq);
+            Lanes::store(s.ic2eq, ic2eq);
+        }
+
+        Vector tick(Vector v0) noexcept
+        {
+            auto next1 = Lanes::add(Lanes::sub(Lanes::mul(k11, ic1eq), Lanes::mul(twoA2, ic2eq)), Lanes::mul(twoA2, v0));
+            auto next2 = Lanes::add(Lanes::add(Lanes::mul(twoA2, ic1eq), Lanes::mul(k22, ic2eq)), Lanes::mul(twoA3, v0));
+
+            auto y = Lanes::add(Lanes::mul(m0, v0),
+                                Lanes::add(Lanes::mul(halfM1, Lanes::add(ic1eq, next1)),
+                                           Lanes::mul(halfM2, Lanes::add(ic2eq, next2))));
+
+            ic1eq = next1;
+            ic2eq = next2;
+
+            return y;
+        }
+    };
+
+    template <typename Lanes>
+    inline void processCascade(const LaneCoefficients<typename Lanes::Sample>* coefficients,
+                               LaneState<typename Lanes::Sample>* states,
+                               const int* sectionIndices, int numSections,
+                               typename Lanes::Sample* interleaved, int numSamples) noexcept
+    {
+        constexpr int width = Lanes::width;
+
+        if (numSamples <= 0)
+            return;
+
+        int section = 0;
+
+        // Sections run two at a time with a one-sample skew: the second section works on the frame
+        // the first one finished in the previous iteration. That gives the CPU two independent
+        // recurrences to overlap, so a stereo cascade isn't bound by the latency of a single one.
+        // The sub-block stays in L1 between pairs.
+        for (; section + 1 < numSections; section += 2)
+        {
+            auto firstIndex = sectionIndices[section];
+            auto secondIndex = sectionIndices[section + 1];
+
+            SectionRegisters<Lanes> first, second;
+            first.load(coefficients[firstIndex], states[firstIndex]);
+            second.load(coefficients[secondIndex], states[secondIndex]);
+
+            auto pending = first.tick(Lanes::load(interleaved));
+
+            for (int i = 1; i < numSamples; ++i)
+            {
+                auto* frame = interleaved + i * width;
+                auto firstOut = first.tick(Lanes::load(frame));
+
+                Lanes::store(frame - width, second.tick(pending));
+                pending = firstOut;
+            }
+
+            Lanes::store(interleaved + (numSamples - 1) * width, second.tick(pending));
+
+            first.save(states[firstIndex]);
+            second.save(states[secondIndex]);
+        }
+
+        if (section < numSections)
+        {
+            auto lastIndex = sectionIndices[section];
+
+            SectionRegisters<Lanes> last;
+            last.load(coefficients[lastIndex], states[lastIndex]);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto* frame = interleaved + i * width;
+                Lanes::store(frame, last.tick(Lanes::load(frame)));
+            }
+
+            last.save(states[lastIndex]);
+        }
+    }
+
+    template <typename SampleType>
+    struct ScalarLanes
+    {
+        using Sample = SampleType;
+        using Vector = SampleType;
+        static constexpr int width = 1;
+
+        static Vector load(const Sample* p) noexcept           { return *p; }
+        static void store(Sample* p, Vector v) noexcept        { *p = v; }
+        static Vector broadcast(Sample v) noexcept             { return v; }
+        static Vector add(Vector a, Vector b) noexcept         { return a + b; }
+        static Vector sub(Vector a, Vector b) noexcept         { return a - b; }
+        static Vector mul(Vector a, Vector b) noexcept         { return a * b; }
+    };
+}
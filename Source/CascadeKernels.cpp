@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    CascadeKernels.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CascadeKernelImpl.h"
+
+#if FEATHERING_X86
+ #include <emmintrin.h>
+#elif FEATHERING_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace Cascade
+{
+   #if FEATHERING_X86
+    struct SSELanes
+    {
+        using Sample = float;
+        using Vector = __m128;
+        static constexpr int width = 4;
+
+        static Vector load(const float* p) noexcept            { return _mm_loadu_ps(p); }
+        static void store(float* p, Vector v) noexcept         { _mm_storeu_ps(p, v); }
+        static Vector broadcast(float v) noexcept              { return _mm_set1_ps(v); }
+        static Vector add(Vector a, Vector b) noexcept         { return _mm_add_ps(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept         { return _mm_sub_ps(a, b); }
+        static Vector mul(Vector a, Vector b) noexcept         { return _mm_mul_ps(a, b); }
+    };
+
+    struct SSEDoubleLanes
+    {
+        using Sample = double;
+        using Vector = __m128d;
+        static constexpr int width = 2;
+
+        static Vector load(const double* p) noexcept           { return _mm_loadu_pd(p); }
+        static void store(double* p, Vector v) noexcept        { _mm_storeu_pd(p, v); }
+        static Vector broadcast(double v) noexcept             { return _mm_set1_pd(v); }
+        static Vector add(Vector a, Vector b) noexcept         { return _mm_add_pd(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept         { return _mm_sub_pd(a, b); }
+        static Vector mul(Vector a, Vector b) noexcept         { return _mm_mul_pd(a, b); }
+    };
+   #endif
+
+   #if FEATHERING_NEON
+    struct NEONLanes
+    {
+        using Sample = float;
+        using Vector = float32x4_t;
+        static constexpr int width = 4;
+
+        static Vector load(const float* p) noexcept            { return vld1q_f32(p); }
+        static void store(float* p, Vector v) noexcept         { vst1q_f32(p, v); }
+        static Vector broadcast(float v) noexcept              { return vdupq_n_f32(v); }
+        static Vector add(Vector a, Vector b) noexcept         { return vaddq_f32(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept         { return vsubq_f32(a, b); }
+        static Vector mul(Vector a, Vector b) noexcept         { return vmulq_f32(a, b); }
+    };
+   #endif
+
+   #if FEATHERING_NEON64
+    struct NEONDoubleLanes
+    {
+        using Sample = double;
+        using Vector = float64x2_t;
+        static constexpr int width = 2;
+
+        static Vector load(const double* p) noexcept           { return vld1q_f64(p); }
+        static void store(double* p, Vector v) noexcept        { vst1q_f64(p, v); }
+        static Vector broadcast(double v) noexcept             { return vdupq_n_f64(v); }
+        static Vector add(Vector a, Vector b) noexcept         { return vaddq_f64(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept         { return vsubq_f64(a, b); }
+        static Vector mul(Vector a, Vector b) noexcept         { return vmulq_f64(a, b); }
+    };
+   #endif
+
+    template <typename SampleType>
+    int getLaneWidth(KernelType type) noexcept
+    {
+        constexpr int bytesPerLane = (int) sizeof(SampleType);
+
+        switch (type)
+        {
+            case KernelType::sse:     return 16 / bytesPerLane;
+            case KernelType::avx:     return 32 / bytesPerLane;
+            case KernelType::neon:    return 16 / bytesPerLane;
+            case KernelType::scalar:
+            default:                  return 1;
+        }
+    }
+
+    template <typename SampleType>
+    bool isSupported(KernelType type) noexcept
+    {
+        switch (type)
+        {
+           #if FEATHERING_X86
+            case KernelType::sse:     return juce::SystemStats::hasSSE2();
+            case KernelType::avx:     return juce::SystemStats::hasAVX();
+           #endif
+           #if FEATHERING_NEON
+            case KernelType::neon:    return std::is_same_v<SampleType, float> || FEATHERING_NEON64;
+           #endif
+            case KernelType::scalar:  return true;
+            default:                  return false;
+        }
+    }
+
+    template <typename SampleType>
+    KernelType getBestKernelType(int numChannels) noexcept
+    {
+        if (numChannels <= 1)
+            return KernelType::scalar;
+
+        for (auto type : { KernelType::sse, KernelType::neon, KernelType::avx })
+            if (isSupported<SampleType>(type) && getLaneWidth<SampleType>(type) >= numChannels)
+                return type;
+
+        // Wider than any register: use the widest one and run several lane groups
+        for (auto type : { KernelType::avx, KernelType::sse, KernelType::neon })
+            if (isSupported<SampleType>(type))
+                return type;
+
+        return KernelType::scalar;
+    }
+
+    template <>
+    KernelFunction<float> getKernel<float>(KernelType type) noexcept
+    {
+        jassert(isSupported<float>(type));
+
+        switch (type)
+        {
+           #if FEATHERING_X86
+            case KernelType::sse:     return processCascade<SSELanes>;
+            case KernelType::avx:     return processCascadeAVX;
+           #endif
+           #if FEATHERING_NEON
+            case KernelType::neon:    return processCascade<NEONLanes>;
+           #endif
+            case KernelType::scalar:
+            default:                  return processCascade<ScalarLanes<float>>;
+        }
+    }
+
+    template <>
+    KernelFunction<double> getKernel<double>(KernelType type) noexcept
+    {
+        jassert(isSupported<double>(type));
+
+        switch (type)
+        {
+           #if FEATHERING_X86
+            case KernelType::sse:     return processCascade<SSEDoubleLanes>;
+            case KernelType::avx:     return processCascadeAVX;
+           #endif
+           #if FEATHERING_NEON64
+            case KernelType::neon:    return processCascade<NEONDoubleLanes>;
+           #endif
+            case KernelType::scalar:
+            default:                  return processCascade<ScalarLanes<double>>;
+        }
+    }
+
+    template int getLaneWidth<float>(KernelType) noexcept;
+    template int getLaneWidth<double>(KernelType) noexcept;
+    template bool isSupported<float>(KernelType) noexcept;
+    template bool isSupported<double>(KernelType) noexcept;
+    template KernelType getBestKernelType<float>(int) noexcept;
+    template KernelType getBestKernelType<double>(int) noexcept;
+
+    const char* getKernelName(KernelType type) noexcept
+    {
+        switch (type)
+        {
+            case KernelType::sse:     return "SSE";
+            case KernelType::avx:     return "AVX";
+            case KernelType::neon:    return "NEON";
+            case KernelType::scalar:
+            default:                  return "Scalar";
+        }
+    }
+}
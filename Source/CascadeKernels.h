@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    CascadeKernels.h
+
+    Runs a cascade of SVF sections over several channels in lockstep, one
+    channel per SIMD lane. Audio is interleaved (sample n, lane l lives at
+    data[n * laneWidth + l]) and coefficients and states are stored
+    struct-of-arrays, so each section costs one vector load per coefficient
+    per sub-block, however many channels share it.
+
+    The kernel is picked at runtime from what the CPU supports. The AVX
+    kernel lives in its own translation unit, so nothing outside it is
+    compiled for AVX.
+
+    Everything is templated on the sample type. Double lanes are half as
+    many per register (SSE2 takes two channels, AVX four), and NEON only
+    has them on 64-bit ARM.
+
+    This header is deliberately free of JuceHeader.h so the AVX translation
+    unit can include it without recompiling JUCE's inline code for AVX.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #define FEATHERING_X86 1
+#else
+ #define FEATHERING_X86 0
+#endif
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64)
+ #define FEATHERING_NEON 1
+#else
+ #define FEATHERING_NEON 0
+#endif
+
+#if FEATHERING_NEON && (defined (__aarch64__) || defined (_M_ARM64))
+ #define FEATHERING_NEON64 1
+#else
+ #define FEATHERING_NEON64 0
+#endif
+
+namespace Cascade
+{
+    static constexpr int maxLanes = 8;
+
+    template <typename SampleType>
+    struct alignas(32) LaneCoefficients
+    {
+        SampleType a1[maxLanes], a2[maxLanes], a3[maxLanes];
+        SampleType m0[maxLanes], m1[maxLanes], m2[maxLanes];
+    };
+
+    template <typename SampleType>
+    struct alignas(32) LaneState
+    {
+        SampleType ic1eq[maxLanes], ic2eq[maxLanes];
+    };
+
+    enum class KernelType
+    {
+        scalar,
+        sse,
+        avx,
+        neon
+    };
+
+    // Processes numSamples interleaved frames in place through the sections listed in sectionIndices,
+    // in that order. Sections not in the list are skipped without touching their state.
+    template <typename SampleType>
+    using KernelFunction = void (*)(const LaneCoefficients<SampleType>* coefficients, LaneState<SampleType>* states,
+                                    const int* sectionIndices, int numSections,
+                                    SampleType* interleaved, int numSamples);
+
+    // Instantiated for float and double in CascadeKernels.cpp
+    template <typename SampleType = float> int getLaneWidth(KernelType type) noexcept;
+    template <typename SampleType = float> bool isSupported(KernelType type) noexcept;
+
+    // The narrowest supported kernel whose lanes cover numChannels, so stereo doesn't pay for idle AVX lanes.
+    template <typename SampleType = float> KernelType getBestKernelType(int numChannels) noexcept;
+
+    template <typename SampleType = float> KernelFunction<SampleType> getKernel(KernelType type) noexcept;
+    template <> KernelFunction<float> getKernel<float>(KernelType type) noexcept;
+    template <> KernelFunction<double> getKernel<double>(KernelType type) noexcept;
+
+    const char* getKernelName(KernelType type) noexcept;
+
+   #if FEATHERING_X86
+    // Defined in CascadeKernelsAVX.cpp
+    void processCascadeAVX(const LaneCoefficients<float>*, LaneState<float>*, const int*, int, float*, int) noexcept;
+    void processCascadeAVX(const LaneCoefficients<double>*, LaneState<double>*, const int*, int, double*, int) noexcept;
+   #endif
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    CascadeKernelsAVX.cpp
+
+    The AVX cascade kernels: 8 float lanes or 4 double lanes. Only this
+    file is compiled for AVX, and it is only called after
+    Cascade::isSupported confirmed the CPU has it. It must not include
+    JuceHeader.h: inline functions compiled here could otherwise be picked
+    by the linker for the rest of the plugin.
+
+  ==============================================================================
+*/
+
+#include "CascadeKernels.h"
+
+#if FEATHERING_X86
+
+#if defined (__clang__)
+ #pragma clang attribute push (__attribute__((target("avx"))), apply_to = function)
+#elif defined (__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target ("avx")
+#endif
+
+#include <immintrin.h>
+#include "CascadeKernelImpl.h"
+
+namespace Cascade
+{
+    namespace
+    {
+        struct AVXLanes
+        {
+            using Sample = float;
+            using Vector = __m256;
+            static constexpr int width = 8;
+
+            static Vector load(const float* p) noexcept            { return _mm256_loadu_ps(p); }
+            static void store(float* p, Vector v) noexcept         { _mm256_storeu_ps(p, v); }
+            static Vector broadcast(float v) noexcept              { return _mm256_set1_ps(v); }
+            static Vector add(Vector a, Vector b) noexcept         { return _mm256_add_ps(a, b); }
+            static Vector sub(Vector a, Vector b) noexcept         { return _mm256_sub_ps(a, b); }
+            static Vector mul(Vector a, Vector b) noexcept         { return _mm256_mul_ps(a, b); }
+        };
+
+        struct AVXDoubleLanes
+        {
+            using Sample = double;
+            using Vector = __m256d;
+            static constexpr int width = 4;
+
+            static Vector load(const double* p) noexcept           { return _mm256_loadu_pd(p); }
+            static void store(double* p, Vector v) noexcept        { _mm256_storeu_pd(p, v); }
+            static Vector broadcast(double v) noexcept             { return _mm256_set1_pd(v); }
+            static Vector add(Vector a, Vector b) noexcept         { return _mm256_add_pd(a, b); }
+            static Vector sub(Vector a, Vector b) noexcept         { return _mm256_sub_pd(a, b); }
+            static Vector mul(Vector a, Vector b) noexcept         { return _mm256_mul_pd(a, b); }
+        };
+    }
+
+    void processCascadeAVX(const LaneCoefficients<float>* coefficients, LaneState<float>* states,
+                           const int* sectionIndices, int numSections,
+                           float* interleaved, int numSamples) noexcept
+    {
+        processCascade<AVXLanes>(coefficients, states, sectionIndices, numSections, interleaved, numSamples);
+    }
+
+    void processCascadeAVX(const LaneCoefficients<double>* coefficients, LaneState<double>* states,
+                           const int* sectionIndices, int numSections,
+                           double* interleaved, int numSamples) noexcept
+    {
+        processCascade<AVXDoubleLanes>(coefficients, states, sectionIndices, numSections, interleaved, numSamples);
+    }
+}
+
+#if defined (__clang__)
+ #pragma clang attribute pop
+#elif defined (__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+#endif
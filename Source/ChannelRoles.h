@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    ChannelRoles.h
+
+    Which channels of the negotiated bus layout sit on the left and on the
+    right, and which pair carries mid/side. Worked out from the channel
+    types once, when the layout is known, so the audio thread only deals in
+    channel masks. Works the same for mono, stereo, 5.1, 7.1.4 or any other
+    layout; channels on neither side (centre, LFE, discrete channels) only
+    get the bands placed on every channel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct ChannelRoles
+{
+    // One bit per channel in a mask
+    static constexpr int maxChannels = 64;
+
+    static constexpr juce::uint64 getChannelBit(int channel) noexcept  { return juce::uint64 (1) << channel; }
+
+    static juce::uint64 getAllChannels(int numChannels) noexcept
+    {
+        return numChannels >= maxChannels ? ~juce::uint64 (0) : getChannelBit(numChannels) - 1;
+    }
+
+    static ChannelRoles fromChannelSet(const juce::AudioChannelSet& channelSet)
+    {
+        using Set = juce::AudioChannelSet;
+
+        ChannelRoles roles;
+        roles.numChannels = juce::jmin(channelSet.size(), maxChannels);
+
+        for (int channel = 0; channel < roles.numChannels; ++channel)
+        {
+            switch (channelSet.getTypeOfChannel(channel))
+            {
+                case Set::left:  case Set::leftSurround:  case Set::leftCentre:  case Set::leftSurroundSide:
+                case Set::leftSurroundRear:  case Set::topFrontLeft:  case Set::topRearLeft:  case Set::wideLeft:
+                case Set::topSideLeft:
+                    roles.leftChannels |= getChannelBit(channel);
+                    break;
+
+                case Set::right:  case Set::rightSurround:  case Set::rightCentre:  case Set::rightSurroundSide:
+                case Set::rightSurroundRear:  case Set::topFrontRight:  case Set::topRearRight:  case Set::wideRight:
+                case Set::topSideRight:
+                    roles.rightChannels |= getChannelBit(channel);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        // Mid/side uses the main front pair
+        auto left = channelSet.getChannelIndexForType(Set::left);
+        auto right = channelSet.getChannelIndexForType(Set::right);
+
+        if (juce::isPositiveAndBelow(left, roles.numChannels) && juce::isPositiveAndBelow(right, roles.numChannels) && left != right)
+        {
+            roles.midChannel = left;
+            roles.sideChannel = right;
+        }
+
+        return roles;
+    }
+
+    bool hasMidSidePair() const noexcept  { return midChannel >= 0 && sideChannel >= 0; }
+
+    int numChannels{ 0 };
+    juce::uint64 leftChannels{ 0 }, rightChannels{ 0 };
+    int midChannel{ -1 }, sideChannel{ -1 };
+};
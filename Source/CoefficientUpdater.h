@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    CoefficientUpdater.h
+
+    Change-driven coefficient updates for the peak bands. A parameter listener
+    flags the band that moved, and the audio thread hands only the flagged
+    bands' new targets to the FeatherEngine, which ramps them and redesigns
+    their coefficients in place. Nothing here allocates or locks.
+
+    Restoring state changes every parameter from the message thread while the
+    audio thread may be running. Between beginRestore() and endRestore() the
+    audio thread leaves the flags alone, and endRestore() then hands over all
+    the restored bands at once through a SettingsExchange, so a recall is
+    never heard half-applied.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BandMask.h"
+#include "FeatherParameters.h"
+#include "SettingsExchange.h"
+
+template <int NumBands>
+class CoefficientUpdater  : private juce::AudioProcessorValueTreeState::Listener
+{
+public:
+    static constexpr int numBands = NumBands;
+
+    explicit CoefficientUpdater(juce::AudioProcessorValueTreeState& state)
+        : apvts(state)
+    {
+        for (int band = 0; band < numBands; ++band)
+        {
+            freqParams[(size_t) band] = apvts.getRawParameterValue(FeatherParameters::getFreqID(band));
+            gainParams[(size_t) band] = apvts.getRawParameterValue(FeatherParameters::getGainID(band));
+            qualityParams[(size_t) band] = apvts.getRawParameterValue(FeatherParameters::getQualityID(band));
+            thresholdParams[(size_t) band] = apvts.getRawParameterValue(FeatherParameters::getThresholdID(band));
+            ratioParams[(size_t) band] = apvts.getRawParameterValue(FeatherParameters::getRatioID(band));
+            placementParams[(size_t) band] = apvts.getRawParameterValue(FeatherParameters::getPlacementID(band));
+
+            jassert(freqParams[(size_t) band] != nullptr && gainParams[(size_t) band] != nullptr && qualityParams[(size_t) band] != nullptr);
+            jassert(thresholdParams[(size_t) band] != nullptr && ratioParams[(size_t) band] != nullptr && placementParams[(size_t) band] != nullptr);
+
+            for (const auto& id : getBandParameterIDs(band))
+                apvts.addParameterListener(id, this);
+        }
+
+        dirtyBands.setAll();
+    }
+
+    ~CoefficientUpdater() override
+    {
+        for (int band = 0; band < numBands; ++band)
+            for (const auto& id : getBandParameterIDs(band))
+                apvts.removeParameterListener(id, this);
+    }
+
+    void markAllBandsDirty() noexcept
+    {
+        dirtyBands.setAll();
+    }
+
+    // Passes the current settings of every band flagged since the last call, and every band of
+    // a newly restored state, to each target (anything with setBandTarget(int, const BandSettings&),
+    // such as the engine and the response curve). Returns the number of band updates made.
+    // Lock-free and allocation-free, so it is safe to call at the top of processBlock.
+    template <typename... Targets>
+    int updateDirtyBands(Targets&... targets) noexcept
+    {
+        if (restoreInProgress.load(std::memory_order_acquire))
+            return 0;
+
+        int numUpdated = 0;
+
+        if (auto* restored = restoredSettings.pull())
+        {
+            for (int band = 0; band < numBands; ++band)
+                (targets.setBandTarget(band, restored->bands[(size_t) band]), ...);
+
+            numUpdated = numBands;
+        }
+
+        return numUpdated + dirtyBands.consume([&](int band)
+        {
+            auto settings = getBandSettings(band);
+            (targets.setBandTarget(band, settings), ...);
+        });
+    }
+
+    // Drops pending changes unsent, for while something other than the parameters drives the bands
+    void discardDirtyBands() noexcept
+    {
+        if (restoreInProgress.load(std::memory_order_acquire))
+            return;
+
+        restoredSettings.pull();
+        dirtyBands.clear();
+    }
+
+    // Message thread, around a state restore. Until endRestore() the audio thread keeps the
+    // bands it has; endRestore() then publishes the restored bands as a single update.
+    void beginRestore() noexcept
+    {
+        restoreInProgress.store(true, std::memory_order_release);
+    }
+
+    void endRestore() noexcept
+    {
+        auto& restored = restoredSettings.getBackBuffer();
+
+        for (int band = 0; band < numBands; ++band)
+            restored.bands[(size_t) band] = getBandSettings(band);
+
+        restoredSettings.publish();
+        restoreInProgress.store(false, std::memory_order_release);
+    }
+
+    BandSettings getBandSettings(int band) const noexcept
+    {
+        BandSettings settings;
+
+        settings.freq = freqParams[(size_t) band]->load();
+        settings.gainInDecibels = gainParams[(size_t) band]->load();
+        settings.quality = qualityParams[(size_t) band]->load();
+        settings.thresholdInDecibels = thresholdParams[(size_t) band]->load();
+        settings.ratio = ratioParams[(size_t) band]->load();
+        settings.placement = juce::roundToInt(placementParams[(size_t) band]->load());
+
+        return settings;
+    }
+
+private:
+    static std::array<juce::String, 6> getBandParameterIDs(int band)
+    {
+        return { FeatherParameters::getFreqID(band), FeatherParameters::getGainID(band), FeatherParameters::getQualityID(band),
+                 FeatherParameters::getThresholdID(band), FeatherParameters::getRatioID(band), FeatherParameters::getPlacementID(band) };
+    }
+
+    void parameterChanged(const juce::String& parameterID, float) override
+    {
+        // Band parameter IDs all end in the band number, counting from 1
+        auto band = parameterID.getTrailingIntValue() - 1;
+
+        if (juce::isPositiveAndBelow(band, numBands))
+            dirtyBands.set(band);
+    }
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    std::array<std::atomic<float>*, (size_t) NumBands> freqParams{}, gainParams{}, qualityParams{};
+    std::array<std::atomic<float>*, (size_t) NumBands> thresholdParams{}, ratioParams{}, placementParams{};
+
+    AtomicBandMask<NumBands> dirtyBands;
+
+    SettingsExchange<ChainSettings<NumBands>> restoredSettings;
+    std::atomic<bool> restoreInProgress{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientUpdater)
+};
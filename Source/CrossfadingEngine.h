@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    CrossfadingEngine.h
+
+    Two FeatherEngines, one playing and one on standby, so the bank can jump
+    between settings without clicking or sweeping. Small moves ramp on the
+    playing engine as usual. A move too far to ramp cleanly (a snapshot
+    recall, a morph jump, a restored state, a knob clicked to a new spot,
+    a band moved to other channels, a new channel mode or cut slope)
+    starts the standby engine from rest on the new settings and crossfades
+    to it while the old one keeps running on the old settings.
+
+    Both engines, the second copy of the signal and the fade ramp are all
+    allocated in prepare(), so nothing here allocates on the audio thread.
+    Outside a crossfade the standby engine costs nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FeatherEngine.h"
+
+template <int NumBands, typename SampleType = float>
+class CrossfadingEngine
+{
+public:
+    static constexpr int numBands = NumBands;
+
+    // A band moving further than any of these in one step is crossfaded rather than ramped
+    static constexpr float jumpOctaves = 2.f, jumpDecibels = 12.f, jumpQualityOctaves = 2.f;
+
+    CrossfadingEngine() = default;
+
+    void setCrossfadeTime(double seconds) noexcept   { crossfadeSeconds = juce::jmax(0.001, seconds); }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        takePendingJump();
+
+        for (auto& engine : engines)
+            engine.prepare(spec);
+
+        outgoing.setSize((int) spec.numChannels, (int) spec.maximumBlockSize);
+        fadeRamp.assign((size_t) spec.maximumBlockSize, SampleType());
+
+        sampleRate = spec.sampleRate;
+        crossfadeSamplesRemaining = 0;
+    }
+
+    // Realtime-safe, like FeatherEngine::setSampleRate, which it shares the muted-output
+    // requirement with. Any crossfade in flight is cut short.
+    void setSampleRate(double newSampleRate) noexcept
+    {
+        takePendingJump();
+
+        sampleRate = newSampleRate;
+
+        for (auto& engine : engines)
+            engine.setSampleRate(sampleRate);
+
+        crossfadeSamplesRemaining = 0;
+    }
+
+    void reset() noexcept
+    {
+        for (auto& engine : engines)
+            engine.reset();
+
+        crossfadeSamplesRemaining = 0;
+    }
+
+    // Safe to call from the audio thread
+    void setBandTarget(int band, const BandSettings& target) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(band, numBands));
+
+        auto& previous = targets[(size_t) band];
+
+        if (isJump(previous, target))
+            jumpPending = true;
+
+        previous = target;
+
+        // A pending jump takes every band across at once, so there's no point ramping this one first
+        if (! jumpPending)
+            engines[(size_t) playing].setBandTarget(band, target);
+    }
+
+    // Safe to call every block; does nothing unless the settings have changed
+    void setCutTarget(int cut, const CutSettings& target) noexcept
+    {
+        auto& previous = cutTargets[(size_t) cut];
+
+        if (target == previous)
+            return;
+
+        if (target.slope != previous.slope || std::abs(std::log2(target.freq / previous.freq)) > jumpOctaves)
+            jumpPending = true;
+
+        previous = target;
+
+        if (! jumpPending)
+            engines[(size_t) playing].setCutTarget(cut, target);
+    }
+
+    // Message thread, before prepare(), like FeatherEngine::setChannelRoles
+    void setChannelRoles(const ChannelRoles& roles) noexcept
+    {
+        for (auto& engine : engines)
+            engine.setChannelRoles(roles);
+    }
+
+    // Safe to call every block. A new mode is crossfaded to, like any other jump.
+    void setChannelMode(int newMode) noexcept
+    {
+        if (newMode == channelMode)
+            return;
+
+        channelMode = newMode;
+        jumpPending = true;
+    }
+
+    void setDynamicsTimes(float attackMs, float releaseMs) noexcept
+    {
+        for (auto& engine : engines)
+            engine.setDynamicsTimes(attackMs, releaseMs);
+    }
+
+    bool isCrossfading() const noexcept { return crossfadeSamplesRemaining > 0; }
+
+    // The playing engine's tail, or the longer of the two while they crossfade
+    double getTailSeconds() noexcept
+    {
+        auto tail = engines[(size_t) playing].getTailSeconds();
+        return isCrossfading() ? juce::jmax(tail, engines[(size_t) (1 - playing)].getTailSeconds()) : tail;
+    }
+
+    juce::int64 getNumCoefficientUpdates() const noexcept
+    {
+        return engines[0].getNumCoefficientUpdates() + engines[1].getNumCoefficientUpdates();
+    }
+
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+    {
+        auto& block = context.getOutputBlock();
+
+        // A jump that arrives mid-crossfade waits for it to finish
+        if (jumpPending && ! isCrossfading())
+            startCrossfade();
+
+        if (! isCrossfading())
+        {
+            engines[(size_t) playing].process(context);
+            return;
+        }
+
+        auto numSamples = (int) block.getNumSamples();
+        auto numChannels = juce::jmin((int) block.getNumChannels(), outgoing.getNumChannels());
+        auto numFading = juce::jmin(numSamples, crossfadeSamplesRemaining);
+
+        jassert(numSamples <= (int) fadeRamp.size());
+
+        juce::dsp::AudioBlock<SampleType> outgoingBlock(outgoing.getArrayOfWritePointers(), (size_t) numChannels, (size_t) numSamples);
+        outgoingBlock.copyFrom(block.getSubsetChannelBlock(0, (size_t) numChannels));
+
+        engines[(size_t) playing].process(context);
+        engines[(size_t) (1 - playing)].process(juce::dsp::ProcessContextReplacing<SampleType>(outgoingBlock));
+
+        // Both engines see the same input, so their outputs are correlated and a linear fade holds the level
+        auto step = (SampleType) 1 / (SampleType) crossfadeLength;
+        auto gain = (SampleType) 1 - (SampleType) crossfadeSamplesRemaining * step;
+
+        for (int i = 0; i < numFading; ++i)
+            fadeRamp[(size_t) i] = gain + (SampleType) i * step;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* incoming = block.getChannelPointer((size_t) channel);
+            auto* old = outgoing.getWritePointer(channel);
+
+            // incoming = old + ramp * (incoming - old)
+            juce::FloatVectorOperations::subtract(incoming, old, numFading);
+            juce::FloatVectorOperations::multiply(incoming, fadeRamp.data(), numFading);
+            juce::FloatVectorOperations::add(incoming, old, numFading);
+        }
+
+        crossfadeSamplesRemaining -= numFading;
+    }
+
+private:
+    static bool isJump(const BandSettings& from, const BandSettings& to) noexcept
+    {
+        return std::abs(std::log2(to.freq / from.freq)) > jumpOctaves
+            || std::abs(to.gainInDecibels - from.gainInDecibels) > jumpDecibels
+            || std::abs(std::log2(to.quality / from.quality)) > jumpQualityOctaves
+            || to.placement != from.placement;
+    }
+
+    // The engines snap to their targets while the output is muted, so a jump needs no crossfade then
+    void takePendingJump() noexcept
+    {
+        if (! jumpPending)
+            return;
+
+        engines[(size_t) playing].setChannelMode(channelMode);
+
+        for (int band = 0; band < numBands; ++band)
+            engines[(size_t) playing].setBandTarget(band, targets[(size_t) band]);
+
+        for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+            engines[(size_t) playing].setCutTarget(cut, cutTargets[(size_t) cut]);
+
+        jumpPending = false;
+    }
+
+    void startCrossfade() noexcept
+    {
+        auto incoming = 1 - playing;
+        auto& engine = engines[(size_t) incoming];
+
+        engine.setChannelMode(channelMode);
+
+        for (int band = 0; band < numBands; ++band)
+            engine.setBandTarget(band, targets[(size_t) band]);
+
+        for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+            engine.setCutTarget(cut, cutTargets[(size_t) cut]);
+
+        // The new settings sound straight away, from a clean state
+        engine.snapToTargets();
+        engine.reset();
+
+        playing = incoming;
+        jumpPending = false;
+
+        crossfadeLength = juce::jmax(1, juce::roundToInt(crossfadeSeconds * sampleRate));
+        crossfadeSamplesRemaining = crossfadeLength;
+    }
+
+    std::array<FeatherEngine<NumBands, SampleType>, 2> engines;
+    int playing{ 0 };
+
+    std::array<BandSettings, (size_t) NumBands> targets{};
+    CutSettingsArray cutTargets{};
+    int channelMode{ FeatherParameters::linked };
+    bool jumpPending{ false };
+
+    juce::AudioBuffer<SampleType> outgoing;
+    std::vector<SampleType> fadeRamp;
+
+    double sampleRate{ 44100.0 };
+    double crossfadeSeconds{ 0.03 };
+    int crossfadeLength{ 1 }, crossfadeSamplesRemaining{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CrossfadingEngine)
+};
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    CutFilter.h
+
+    Butterworth low- and high-cut slopes as cascades of second-order SVF
+    sections, one section per 12 dB/oct. Each slope is a specialisation of
+    its own: the section count and every section's Q are compile-time
+    constants, so a 24 dB/oct cut is designed and run as exactly two
+    sections, with nothing bypassed and no per-section branches.
+
+    The sections run in the FeatherEngine's cascade, through the same SIMD
+    kernels as the bands: low cut first, then the bands, then high cut.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FeatherParameters.h"
+
+namespace CutFilter
+{
+    constexpr int maxSections = 8;
+
+    // Sections for each FeatherParameters::CutSlope
+    constexpr std::array<int, (size_t) FeatherParameters::numCutSlopes> sectionsPerSlope{ 0, 1, 2, 3, 4, 6, 8 };
+
+    constexpr int getNumSections(int slope) noexcept
+    {
+        return slope > 0 && slope < FeatherParameters::numCutSlopes ? sectionsPerSlope[(size_t) slope] : 0;
+    }
+
+    namespace Detail
+    {
+        // sin(x) over [0, pi / 2], as a series the compiler can evaluate
+        constexpr double sine(double x) noexcept
+        {
+            auto term = x, sum = x;
+
+            for (int n = 1; n < 12; ++n)
+            {
+                term *= -x * x / (double) ((2 * n) * (2 * n + 1));
+                sum += term;
+            }
+
+            return sum;
+        }
+    }
+
+    template <int NumSections>
+    struct Butterworth
+    {
+        static_assert(NumSections > 0 && NumSections <= maxSections, "Not a slope on offer");
+
+        static constexpr int numSections = NumSections;
+
+        // Pole pair k of an order 2N Butterworth has Q = 1 / (2 sin((2k - 1) pi / 4N))
+        static constexpr std::array<double, (size_t) NumSections> qualities = []
+        {
+            std::array<double, (size_t) NumSections> q{};
+
+            for (int k = 0; k < NumSections; ++k)
+                q[(size_t) k] = 1.0 / (2.0 * Detail::sine((2 * k + 1) * 3.14159265358979323846 / (4 * NumSections)));
+
+            return q;
+        }();
+    };
+
+    // Calls function with the Butterworth specialisation for a slope's section count
+    template <typename Function>
+    void visitSlope(int numSections, Function&& function)
+    {
+        switch (numSections)
+        {
+            case 1:  function(Butterworth<1>{}); break;
+            case 2:  function(Butterworth<2>{}); break;
+            case 3:  function(Butterworth<3>{}); break;
+            case 4:  function(Butterworth<4>{}); break;
+            case 6:  function(Butterworth<6>{}); break;
+            case 8:  function(Butterworth<8>{}); break;
+            default: break;
+        }
+    }
+
+    static_assert(Butterworth<1>::qualities[0] > 0.7071067 && Butterworth<1>::qualities[0] < 0.7071068, "12 dB/oct is Q 1 / sqrt(2)");
+}
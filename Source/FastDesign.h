@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    FastDesign.h
+
+    Approximate, allocation-free SVF coefficient design for bands that are
+    redesigned at high rates: ramps and dynamic bands. makePeakSVF() and
+    JUCE's IIR::Coefficients::makePeakFilter call std::tan and std::pow in
+    double precision, and the JUCE version returns a heap object. Here tan
+    comes from a Padé approximant and 10^(dB / 40) from a short exp series
+    squared three times, all in float and without branches, so the batch
+    functions vectorise across bands. Everything but the exact tier is
+    constexpr.
+
+    Accuracy tiers, over 0 to 0.49 fs and +/-48 dB, against tan and 10^x in
+    double precision. Float rounding sets the floor, which is what limits
+    the first two; getErrorBounds() holds these and the benchmark checks them.
+        exact   std::tan and std::exp: g within 5e-6 relative, amplitude within 5e-6 dB
+        high    g within 5e-7 relative, amplitude within 3e-5 dB
+        fast    g within 3e-4 relative, amplitude within 0.004 dB
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SVFSection.h"
+
+namespace FastDesign
+{
+    enum class Accuracy
+    {
+        exact,
+        high,
+        fast
+    };
+
+    constexpr float pi = 3.14159265358979f;
+    constexpr float maxNormalisedFrequency = 0.49f;
+    constexpr float maxGainInDecibels = 48.f;
+
+    // The worst errors a tier makes over the range above
+    struct ErrorBounds
+    {
+        double prewarpRelative, amplitudeDecibels;
+    };
+
+    constexpr ErrorBounds getErrorBounds(Accuracy accuracy) noexcept
+    {
+        switch (accuracy)
+        {
+            case Accuracy::exact:  return { 5.0e-6, 5.0e-6 };
+            case Accuracy::high:   return { 5.0e-7, 3.0e-5 };
+            case Accuracy::fast:   return { 3.0e-4, 0.004 };
+        }
+
+        return {};
+    }
+
+    //==============================================================================
+    // The prewarped frequency g = tan(pi * f / fs), from f / fs
+    template <Accuracy accuracy>
+    constexpr float prewarp(float normalisedFrequency) noexcept
+    {
+        if constexpr (accuracy == Accuracy::exact)
+        {
+            return std::tan(pi * juce::jmin(normalisedFrequency, maxNormalisedFrequency));
+        }
+        else
+        {
+            // The clamp and the reflection are blended in arithmetically rather than branched on,
+            // which is what lets a loop over this vectorise.
+            auto over = normalisedFrequency > maxNormalisedFrequency ? 1.f : 0.f;
+            auto f = normalisedFrequency + over * (maxNormalisedFrequency - normalisedFrequency);
+
+            // Above fs / 4, tan(x) = 1 / tan(pi / 2 - x) keeps the approximant within [0, pi / 4]
+            auto reflected = f > 0.25f ? 1.f : 0.f;
+            auto x = pi * (f + reflected * (0.5f - 2.f * f));
+            auto x2 = x * x;
+
+            auto t = accuracy == Accuracy::high ? x * (945.f + x2 * (-105.f + x2)) / (945.f + x2 * (-420.f + 15.f * x2))
+                                                : x * (15.f - x2) / (15.f - 6.f * x2);
+
+            // The tiny offset keeps 1 / t finite at 0 Hz, where it's blended out anyway
+            auto inverse = 1.f / (t + 1.0e-30f);
+            return t + reflected * (inverse - t);
+        }
+    }
+
+    // 10^(decibels / divisor): a divisor of 40 gives a bell's or shelf's A, 80 gives sqrt(A)
+    template <Accuracy accuracy>
+    constexpr float decibelsToAmplitude(float decibels, float divisor) noexcept
+    {
+        constexpr float ln10 = 2.30258509299f;
+
+        if constexpr (accuracy == Accuracy::exact)
+        {
+            return std::exp(decibels * ln10 / divisor);
+        }
+        else
+        {
+            // e^u = (e^(u / 8))^8, and u / 8 is small enough for a few terms of the series
+            auto v = decibels * ln10 / (8.f * divisor);
+
+            auto e = accuracy == Accuracy::high
+                         ? 1.f + v * (1.f + v * (1.f / 2.f) * (1.f + v * (1.f / 3.f) * (1.f + v * (1.f / 4.f) * (1.f + v * (1.f / 5.f) * (1.f + v * (1.f / 6.f))))))
+                         : 1.f + v * (1.f + v * (1.f / 2.f) * (1.f + v * (1.f / 3.f) * (1.f + v * (1.f / 4.f))));
+
+            e *= e;
+            e *= e;
+            return e * e;
+        }
+    }
+
+    //==============================================================================
+    // Bell from its prewarped frequency and amplitude, the same response as makePeakSVF()
+    constexpr SVFCoefficients makePeakPrewarped(float g, float quality, float A) noexcept
+    {
+        auto k = 1.f / (quality * A);
+        auto a1 = 1.f / (1.f + g * (g + k));
+        auto a2 = g * a1;
+
+        return { a1, a2, g * a2, 1.f, k * (A * A - 1.f), 0.f };
+    }
+
+    // Cut filter sections from their prewarped frequency, the same responses as makeLowPassSVF() and makeHighPassSVF()
+    constexpr SVFCoefficients makeLowPassPrewarped(float g, float quality) noexcept
+    {
+        auto k = 1.f / quality;
+        auto a1 = 1.f / (1.f + g * (g + k));
+        auto a2 = g * a1;
+
+        return { a1, a2, g * a2, 0.f, 0.f, 1.f };
+    }
+
+    constexpr SVFCoefficients makeHighPassPrewarped(float g, float quality) noexcept
+    {
+        auto k = 1.f / quality;
+        auto a1 = 1.f / (1.f + g * (g + k));
+        auto a2 = g * a1;
+
+        return { a1, a2, g * a2, 1.f, -k, -1.f };
+    }
+
+    template <Accuracy accuracy>
+    constexpr SVFCoefficients makePeak(float normalisedFrequency, float quality, float gainInDecibels) noexcept
+    {
+        return makePeakPrewarped(prewarp<accuracy>(normalisedFrequency), quality,
+                                 decibelsToAmplitude<accuracy>(gainInDecibels, 40.f));
+    }
+
+    // Shelves put the corner where the gain is half-way, in dB, like the bell's centre
+    template <Accuracy accuracy>
+    constexpr SVFCoefficients makeLowShelf(float normalisedFrequency, float quality, float gainInDecibels) noexcept
+    {
+        auto A = decibelsToAmplitude<accuracy>(gainInDecibels, 40.f);
+        auto g = prewarp<accuracy>(normalisedFrequency) / decibelsToAmplitude<accuracy>(gainInDecibels, 80.f);
+        auto k = 1.f / quality;
+        auto a1 = 1.f / (1.f + g * (g + k));
+        auto a2 = g * a1;
+
+        return { a1, a2, g * a2, 1.f, k * (A - 1.f), A * A - 1.f };
+    }
+
+    template <Accuracy accuracy>
+    constexpr SVFCoefficients makeHighShelf(float normalisedFrequency, float quality, float gainInDecibels) noexcept
+    {
+        auto A = decibelsToAmplitude<accuracy>(gainInDecibels, 40.f);
+        auto g = prewarp<accuracy>(normalisedFrequency) * decibelsToAmplitude<accuracy>(gainInDecibels, 80.f);
+        auto k = 1.f / quality;
+        auto a1 = 1.f / (1.f + g * (g + k));
+        auto a2 = g * a1;
+
+        return { a1, a2, g * a2, A * A, k * (1.f - A) * A, 1.f - A * A };
+    }
+
+    //==============================================================================
+    // Many bands at once, struct-of-arrays in and out so the loops vectorise
+    struct CoefficientColumns
+    {
+        float* a1;
+        float* a2;
+        float* a3;
+        float* m0;
+        float* m1;
+        float* m2;
+    };
+
+    template <Accuracy accuracy>
+    void prewarp(const float* normalisedFrequencies, float* g, int numBands) noexcept
+    {
+        for (int i = 0; i < numBands; ++i)
+            g[i] = prewarp<accuracy>(normalisedFrequencies[i]);
+    }
+
+    namespace Detail
+    {
+        // The columns mustn't overlap each other or the inputs. Saying so spares the vectoriser
+        // more run-time overlap checks than it's willing to make.
+        template <Accuracy accuracy>
+        void makePeaksPrewarped(const float* __restrict g, const float* __restrict qualities, const float* __restrict gainsInDecibels,
+                                float* __restrict a1, float* __restrict a2, float* __restrict a3,
+                                float* __restrict m0, float* __restrict m1, float* __restrict m2, int numBands) noexcept
+        {
+            for (int i = 0; i < numBands; ++i)
+            {
+                auto c = makePeakPrewarped(g[i], qualities[i], decibelsToAmplitude<accuracy>(gainsInDecibels[i], 40.f));
+
+                a1[i] = c.a1;
+                a2[i] = c.a2;
+                a3[i] = c.a3;
+                m0[i] = c.m0;
+                m1[i] = c.m1;
+                m2[i] = c.m2;
+            }
+        }
+    }
+
+    template <Accuracy accuracy>
+    void makePeaksPrewarped(const float* g, const float* qualities, const float* gainsInDecibels,
+                            CoefficientColumns out, int numBands) noexcept
+    {
+        Detail::makePeaksPrewarped<accuracy>(g, qualities, gainsInDecibels,
+                                             out.a1, out.a2, out.a3, out.m0, out.m1, out.m2, numBands);
+    }
+
+    //==============================================================================
+    static_assert(decibelsToAmplitude<Accuracy::high>(0.f, 40.f) == 1.f, "0 dB must be exactly unity");
+    static_assert(makePeak<Accuracy::fast>(0.1f, 1.f, 0.f).m1 == 0.f, "a 0 dB bell must be exactly flat");
+}
@@ -0,0 +1,1116 @@
+/*
+  ==============================================================================
+
+    FeatherEngine.h
+
+    The peak-band cascade for a bank of NumBands bands. Each band's frequency,
+    gain and Q ramp towards their targets in a perceptual domain (log
+    frequency, dB gain, log Q), and the band coefficients are redesigned once
+    per control interval rather than per sample, so automation is zipper-free
+    without a per-sample redesign.
+
+    Channels run in lockstep through the SIMD cascade kernels in
+    CascadeKernels.h, one channel per lane, whatever the bus layout. Each
+    band is designed once and written into the lanes of the channels it is
+    placed on; the other lanes get a pass-through section. Which channels
+    those are comes from the band's placement, the channel mode and the
+    ChannelRoles of the layout, so nothing here knows about left and right.
+
+    Band data lives in flat arrays indexed by band. Only bands that are
+    ramping are visited at a control tick, and only bands that aren't sitting
+    at 0 dB are handed to the kernel, so a large bank of mostly flat bands
+    costs little more than its active ones.
+
+    Dynamic bands (see BandSettings::isDynamic) also get a detector from
+    BandDynamics.h. Linked, one detector hears the mono sum of the input;
+    otherwise each channel has its own, and its own gain. At each control
+    tick the gain moves between 0 dB and the set gain.
+
+    In mid/side mode the front pair is encoded to mid and side before the
+    bands and cuts and decoded after them, whenever any section is running,
+    so no filter's state ever changes domain.
+
+    The low- and high-cut filters (see CutFilter.h) are extra sections in
+    the same cascade, after the bands in the lane arrays and on every
+    channel. Their frequencies ramp like a band's; a new slope isn't
+    ramped, so CrossfadingEngine crossfades to it.
+
+    SampleType is the audio and filter precision. A double engine keeps its
+    filter states and its designs at rest in double, which is what narrow,
+    low bands at high sample rates need. Bands moving at control rate still
+    come from FastDesign's float approximations unless the accuracy is
+    exact, and the level detectors run in float either way.
+
+    Bands that move at control rate, ramping or dynamic, are designed with
+    FastDesign at the chosen accuracy: ramping bands in one batch per tick,
+    dynamic ones from their cached prewarped frequency. A band that comes
+    to rest is designed exactly.
+
+    getTailSeconds() is how long the cascade rings after its input stops,
+    from the pole radius of the slowest active band. Each band's decay is
+    worked out again only when its target changes, so the tail itself is
+    just a max over them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+#include "SVFSection.h"
+#include "CascadeKernels.h"
+#include "BandDynamics.h"
+#include "FastDesign.h"
+#include "FeatherParameters.h"
+#include "ChannelRoles.h"
+#include "CutFilter.h"
+
+template <int NumBands, typename SampleType = float>
+class FeatherEngine
+{
+public:
+    static constexpr int numBands = NumBands;
+
+    // Sections per lane group: the bands, then the low-cut sections, then the high-cut ones
+    static constexpr int numSections = NumBands + FeatherParameters::numCutTypes * CutFilter::maxSections;
+
+    using Coefficients = BasicSVFCoefficients<SampleType>;
+
+   #ifdef FEATHERING_CONTROL_INTERVAL
+    static constexpr int defaultControlInterval = FEATHERING_CONTROL_INTERVAL;
+   #else
+    static constexpr int defaultControlInterval = 16;
+   #endif
+
+    FeatherEngine() = default;
+
+    // Control interval (in samples) and ramp time only take effect on the next prepare() or setSampleRate().
+    void setControlInterval(int numSamples) noexcept
+    {
+        jassert(numSamples > 0);
+        controlInterval = juce::jmax(1, numSamples);
+    }
+
+    int getControlInterval() const noexcept { return controlInterval; }
+
+    // How bands moving at control rate are designed. Safe to call from the audio thread.
+    void setDesignAccuracy(FastDesign::Accuracy newAccuracy) noexcept  { designAccuracy = newAccuracy; }
+    FastDesign::Accuracy getDesignAccuracy() const noexcept             { return designAccuracy; }
+
+    void setSmoothingTime(double seconds) noexcept
+    {
+        smoothingTimeSeconds = juce::jmax(0.0, seconds);
+    }
+
+    // Forces a particular SIMD kernel, e.g. to compare them in a benchmark. By default the
+    // best supported kernel for the channel count is chosen. Takes effect on the next prepare().
+    void setKernelType(Cascade::KernelType type) noexcept
+    {
+        requestedKernelType = type;
+    }
+
+    Cascade::KernelType getKernelType() const noexcept { return kernelType; }
+
+    int getNumActiveBands() const noexcept { return numActiveBands; }
+    int getNumDynamicBands() const noexcept { return numDynamicBands; }
+
+    // Attack and release of the dynamic bands' level followers. Safe to call every block.
+    void setDynamicsTimes(float newAttackMs, float newReleaseMs) noexcept
+    {
+        if (newAttackMs == attackMs && newReleaseMs == releaseMs)
+            return;
+
+        attackMs = newAttackMs;
+        releaseMs = newReleaseMs;
+        setDetectorTimes();
+    }
+
+    // Which channel is which in the bus layout. Takes effect straight away, so call it before
+    // prepare() or while the output is muted.
+    void setChannelRoles(const ChannelRoles& newRoles) noexcept
+    {
+        roles = newRoles;
+        rebuildChannelLayout();
+    }
+
+    // A FeatherParameters::ChannelMode. Like setChannelRoles(), a change isn't smoothed;
+    // CrossfadingEngine only ever changes it on an engine that is about to fade in.
+    void setChannelMode(int newMode) noexcept
+    {
+        if (newMode == channelMode)
+            return;
+
+        channelMode = newMode;
+        rebuildChannelLayout();
+    }
+
+    int getChannelMode() const noexcept  { return channelMode; }
+
+    static constexpr double tailDecibels = 100.0, maxTailSeconds = 30.0;
+
+    // How long the output takes to decay by tailDecibels once the input stops, allowing for
+    // every active band at both its current and its target settings, and for the cut filters.
+    // The decays are worked out when a target changes, so this is only a max over them.
+    double getTailSeconds() noexcept
+    {
+        if (tailIsStale)
+        {
+            tailSeconds = juce::jmax(cutDecaySeconds[0], cutDecaySeconds[1]);
+
+            for (int band = 0; band < numBands; ++band)
+                if (bandIsActive[(size_t) band])
+                    tailSeconds = juce::jmax(tailSeconds, bandDecaySeconds[(size_t) band]);
+
+            tailIsStale = false;
+        }
+
+        return tailSeconds;
+    }
+
+    // Running total of band coefficient designs, for the performance monitor
+    juce::int64 getNumCoefficientUpdates() const noexcept { return numCoefficientUpdates; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = (int) spec.numChannels;
+        jassert(numChannels <= ChannelRoles::maxChannels);
+
+        kernelType = requestedKernelType.value_or(Cascade::getBestKernelType<SampleType>(numChannels));
+
+        if (! Cascade::isSupported<SampleType>(kernelType))
+            kernelType = Cascade::KernelType::scalar;
+
+        kernel = Cascade::getKernel<SampleType>(kernelType);
+        laneWidth = Cascade::getLaneWidth<SampleType>(kernelType);
+        numGroups = (numChannels + laneWidth - 1) / laneWidth;
+
+        groupStates.assign((size_t) (numGroups * numSections), {});
+        groupCoefficients.assign((size_t) (numGroups * numSections), {});
+        interleaved.assign((size_t) (maxChunkSize * laneWidth), SampleType());
+        sidechain.assign((size_t) maxChunkSize, SampleType());
+
+        channelDetectors.assign((size_t) numChannels, {});
+        channelDynamicGains.assign((size_t) (numChannels * numBands), 0.f);
+        rebuildChannelLayout();
+
+        setSampleRate(spec.sampleRate);
+    }
+
+    // Redesigns every band for a new sample rate without reallocating, so the oversampling
+    // factor can change on the audio thread. Ramps in flight jump to their targets and the
+    // filter state is cleared, so only call this while the output is muted.
+    void setSampleRate(double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+
+        // Smoothers advance once per control tick, so their ramp is measured in ticks rather than samples
+        auto rampTicks = juce::jmax(1, juce::roundToInt(smoothingTimeSeconds * sampleRate / controlInterval));
+
+        for (auto& smoother : smoothers)
+        {
+            smoother.freq.reset(rampTicks);
+            smoother.gainInDecibels.reset(rampTicks);
+            smoother.quality.reset(rampTicks);
+        }
+
+        for (auto& cut : cuts)
+            cut.freq.reset(rampTicks);
+
+        setDetectorTimes();
+
+        snapToTargets();
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill(groupStates.begin(), groupStates.end(), Cascade::LaneState<SampleType>{});
+        samplesUntilControlTick = 0;
+
+        dynamics.reset();
+
+        for (auto& detector : channelDetectors)
+            detector.reset();
+    }
+
+    // Sets where a band should ramp to. Safe to call from the audio thread.
+    void setBandTarget(int band, const BandSettings& target) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(band, numBands));
+
+        auto& smoother = smoothers[(size_t) band];
+        auto responseChanged = target.freq != smoother.freq.getTargetValue()
+                            || target.gainInDecibels != smoother.gainInDecibels.getTargetValue()
+                            || target.quality != smoother.quality.getTargetValue();
+
+        smoother.freq.setTargetValue(target.freq);
+        smoother.gainInDecibels.setTargetValue(target.gainInDecibels);
+        smoother.quality.setTargetValue(target.quality);
+
+        if (responseChanged)
+            updateBandDecay(band);
+
+        thresholds[(size_t) band] = target.thresholdInDecibels;
+        ratios[(size_t) band] = target.ratio;
+
+        if (target.placement != placements[(size_t) band])
+        {
+            placements[(size_t) band] = target.placement;
+            bandChannels[(size_t) band] = getPlacementChannels(target.placement);
+            rebuildDynamicBands();
+        }
+
+        if (target.isDynamic() != bandIsDynamic[(size_t) band])
+        {
+            bandIsDynamic[(size_t) band] = target.isDynamic();
+            clearDynamicGains(band);
+            rebuildDynamicBands();
+        }
+
+        if (isSmoothing(smoother))
+            startSmoothing(band);
+        else
+            updateBandCoefficients(band);
+
+        updateActivity(band);
+    }
+
+    // Sets a cut filter's frequency to ramp to, and its slope, which changes straight away.
+    // Safe to call from the audio thread.
+    void setCutTarget(int cut, const CutSettings& target) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(cut, (int) FeatherParameters::numCutTypes));
+
+        auto& stage = cuts[(size_t) cut];
+        auto numCutSections = CutFilter::getNumSections(target.slope);
+        auto slopeChanged = numCutSections != stage.numSections;
+
+        auto freqChanged = target.freq != stage.freq.getTargetValue();
+        stage.freq.setTargetValue(target.freq);
+
+        if (slopeChanged)
+        {
+            // Added sections start from rest
+            for (int group = 0; group < numGroups; ++group)
+                for (int i = stage.numSections; i < numCutSections; ++i)
+                    groupStates[(size_t) (group * numSections + getCutSection(cut, i))] = {};
+
+            stage.numSections = numCutSections;
+            rebuildActiveBands();
+        }
+
+        // A ramp redesigns the sections each control tick; a new slope needs them designed now
+        if (slopeChanged || ! stage.freq.isSmoothing())
+            designCut(cut);
+
+        if (slopeChanged || freqChanged)
+            updateCutDecay(cut);
+    }
+
+    // Jumps every band straight to its target, e.g. after prepare().
+    void snapToTargets() noexcept
+    {
+        for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+        {
+            auto& freq = cuts[(size_t) cut].freq;
+            freq.setCurrentAndTargetValue(freq.getTargetValue());
+            designCut(cut);
+        }
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            auto& smoother = smoothers[(size_t) band];
+
+            smoother.freq.setCurrentAndTargetValue(smoother.freq.getTargetValue());
+            smoother.gainInDecibels.setCurrentAndTargetValue(smoother.gainInDecibels.getTargetValue());
+            smoother.quality.setCurrentAndTargetValue(smoother.quality.getTargetValue());
+
+            updateBandCoefficients(band);
+            updateBandDecay(band);
+            bandIsSmoothing[(size_t) band] = false;
+        }
+
+        for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+            updateCutDecay(cut);
+
+        numSmoothingBands = 0;
+        rebuildActiveBands();
+    }
+
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+    {
+        auto& block = context.getOutputBlock();
+        auto numSamples = (int) block.getNumSamples();
+
+        // While any section runs, the cut sections included, its state stays in the M/S domain
+        auto midSide = channelLayout == FeatherParameters::midSide && (numActiveSections > 0 || numDynamicBands > 0)
+                    && juce::jmax(roles.midChannel, roles.sideChannel) < (int) block.getNumChannels();
+
+        if (midSide)
+            encodeMidSide(block);
+
+        // The control tick counter carries across blocks, so the redesign rate doesn't depend on the host block size
+        for (int start = 0; start < numSamples;)
+        {
+            if (samplesUntilControlTick == 0)
+            {
+                if (numSmoothingBands > 0)
+                    advanceSmoothing();
+
+                if (cuts[0].freq.isSmoothing() || cuts[1].freq.isSmoothing())
+                    advanceCutSmoothing();
+
+                if (numDynamicBands > 0)
+                    updateDynamics();
+
+                samplesUntilControlTick = controlInterval;
+            }
+
+            auto numThisTime = juce::jmin(samplesUntilControlTick, numSamples - start);
+
+            // The detectors hear the input, before the bands they control
+            if (numDynamicBands > 0)
+                accumulateSidechain(block, (size_t) start, numThisTime);
+
+            if (numActiveSections > 0)
+                processSubBlock(block, (size_t) start, numThisTime);
+
+            start += numThisTime;
+            samplesUntilControlTick -= numThisTime;
+        }
+
+        if (midSide)
+            decodeMidSide(block);
+    }
+
+private:
+    struct BandSmoother
+    {
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freq, quality;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gainInDecibels;
+    };
+
+    static bool isSmoothing(const BandSmoother& smoother) noexcept
+    {
+        return smoother.freq.isSmoothing() || smoother.gainInDecibels.isSmoothing() || smoother.quality.isSmoothing();
+    }
+
+    // A bell at exactly 0 dB passes its input unchanged, whatever its frequency and Q, and so
+    // does a band placed on channels the layout doesn't have
+    bool isFlat(int band) const noexcept
+    {
+        const auto& gain = smoothers[(size_t) band].gainInDecibels;
+        return (gain.getCurrentValue() == 0.f && gain.getTargetValue() == 0.f) || bandChannels[(size_t) band] == 0;
+    }
+
+    void startSmoothing(int band) noexcept
+    {
+        if (! bandIsSmoothing[(size_t) band])
+        {
+            bandIsSmoothing[(size_t) band] = true;
+            smoothingBands[(size_t) numSmoothingBands++] = band;
+        }
+    }
+
+    void updateActivity(int band) noexcept
+    {
+        auto shouldBeActive = ! isFlat(band);
+
+        if (shouldBeActive == bandIsActive[(size_t) band])
+            return;
+
+        // A band coming back in starts from rest. Its gain ramps up from 0 dB, so there is nothing to click.
+        if (shouldBeActive)
+            for (int group = 0; group < numGroups; ++group)
+                groupStates[(size_t) (group * numSections + band)] = {};
+
+        rebuildActiveBands();
+    }
+
+    //==============================================================================
+    // Seconds for a section to decay by tailDecibels, capped at maxTailSeconds
+    double getDecaySeconds(double freq, double k) const noexcept
+    {
+        auto decaySamples = getSVFDecaySamples(getPrewarpedFrequency(sampleRate, freq), k, tailDecibels);
+        return juce::jmin(maxTailSeconds, decaySamples / sampleRate);
+    }
+
+    // A band's decay at its target settings and, while it ramps, at its current ones
+    void updateBandDecay(int band) noexcept
+    {
+        const auto& smoother = smoothers[(size_t) band];
+
+        auto getDecay = [this, &smoother](const auto& get)
+        {
+            auto A = std::pow(10.0, get(smoother.gainInDecibels) / 40.0);
+            return getDecaySeconds(get(smoother.freq), 1.0 / (get(smoother.quality) * A));
+        };
+
+        auto decay = getDecay([](const auto& value) { return value.getTargetValue(); });
+
+        if (isSmoothing(smoother))
+            decay = juce::jmax(decay, getDecay([](const auto& value) { return value.getCurrentValue(); }));
+
+        bandDecaySeconds[(size_t) band] = decay;
+        tailIsStale = true;
+    }
+
+    // The first section of a slope has the highest Q, so it rings longest
+    void updateCutDecay(int cut) noexcept
+    {
+        const auto& stage = cuts[(size_t) cut];
+        auto decay = 0.0;
+
+        CutFilter::visitSlope(stage.numSections, [&](auto slope)
+        {
+            auto k = 1.0 / decltype(slope)::qualities[0];
+            decay = juce::jmax(getDecaySeconds(stage.freq.getCurrentValue(), k),
+                               getDecaySeconds(stage.freq.getTargetValue(), k));
+        });
+
+        cutDecaySeconds[(size_t) cut] = decay;
+        tailIsStale = true;
+    }
+
+    // The sections the kernel runs, in order: low cut, the bands that aren't flat, high cut
+    void rebuildActiveBands() noexcept
+    {
+        numActiveBands = 0;
+        numActiveSections = 0;
+        tailIsStale = true;
+
+        auto addCutSections = [this](int cut)
+        {
+            for (int i = 0; i < cuts[(size_t) cut].numSections; ++i)
+                activeSections[(size_t) numActiveSections++] = getCutSection(cut, i);
+        };
+
+        addCutSections(FeatherParameters::lowCut);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            bandIsActive[(size_t) band] = ! isFlat(band);
+
+            if (bandIsActive[(size_t) band])
+            {
+                activeSections[(size_t) numActiveSections++] = band;
+                ++numActiveBands;
+            }
+        }
+
+        addCutSections(FeatherParameters::highCut);
+    }
+
+    //==============================================================================
+    static constexpr int getCutSection(int cut, int index) noexcept
+    {
+        return NumBands + cut * CutFilter::maxSections + index;
+    }
+
+    // Low cut is a high-pass, high cut a low-pass. Sections at rest are designed exactly, ramping ones
+    // at the design accuracy, and each slope's section count and Qs are fixed at compile time.
+    void designCut(int cut) noexcept
+    {
+        const auto& stage = cuts[(size_t) cut];
+        auto freq = stage.freq.getCurrentValue();
+        auto highPass = cut == FeatherParameters::lowCut;
+
+        CutFilter::visitSlope(stage.numSections, [&](auto slope)
+        {
+            using Slope = decltype(slope);
+
+            if (! stage.freq.isSmoothing() || designAccuracy == FastDesign::Accuracy::exact)
+            {
+                auto g = getPrewarpedFrequency(sampleRate, freq);
+
+                for (int i = 0; i < Slope::numSections; ++i)
+                {
+                    auto quality = Slope::qualities[(size_t) i];
+                    setSectionCoefficients(getCutSection(cut, i), highPass ? makeHighPassSVF<SampleType>(g, quality)
+                                                                           : makeLowPassSVF<SampleType>(g, quality));
+                }
+
+                return;
+            }
+
+            auto normalisedFreq = (float) (freq / sampleRate);
+            auto g = designAccuracy == FastDesign::Accuracy::high ? FastDesign::prewarp<FastDesign::Accuracy::high>(normalisedFreq)
+                                                                  : FastDesign::prewarp<FastDesign::Accuracy::fast>(normalisedFreq);
+
+            for (int i = 0; i < Slope::numSections; ++i)
+            {
+                auto quality = (float) Slope::qualities[(size_t) i];
+                auto c = highPass ? FastDesign::makeHighPassPrewarped(g, quality) : FastDesign::makeLowPassPrewarped(g, quality);
+                setSectionCoefficients(getCutSection(cut, i), c.template as<SampleType>());
+            }
+        });
+    }
+
+    void advanceCutSmoothing() noexcept
+    {
+        for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+        {
+            auto& freq = cuts[(size_t) cut].freq;
+
+            if (! freq.isSmoothing())
+                continue;
+
+            // The last step lands on the target and is designed exactly
+            freq.getNextValue();
+            designCut(cut);
+
+            if (! freq.isSmoothing())
+                updateCutDecay(cut);
+        }
+    }
+
+    void updateBandCoefficients(int band) noexcept
+    {
+        auto& smoother = smoothers[(size_t) band];
+        auto quality = smoother.quality.getCurrentValue();
+
+        auto g = getPrewarpedFrequency(sampleRate, smoother.freq.getCurrentValue());
+        prewarpedFreqs[(size_t) band] = g;
+
+        if (bandIsDynamic[(size_t) band])
+        {
+            setDetectorBand(band, g, quality);
+            setDynamicCoefficients(band, [g, quality](float gain) { return makePeakSVF<SampleType>(g, quality, std::pow(10.0, gain / 40.0)); });
+            return;
+        }
+
+        setBandCoefficients(band, makePeakSVF<SampleType>(g, quality, std::pow(10.0, smoother.gainInDecibels.getCurrentValue() / 40.0)));
+    }
+
+    // A dynamic band's bell at the design accuracy, from its cached prewarped frequency
+    Coefficients makeMovingPeak(double g, float quality, float gainInDecibels) const noexcept
+    {
+        using FastDesign::Accuracy;
+
+        switch (designAccuracy)
+        {
+            case Accuracy::high: return FastDesign::makePeakPrewarped((float) g, quality, FastDesign::decibelsToAmplitude<Accuracy::high>(gainInDecibels, 40.f)).template as<SampleType>();
+            case Accuracy::fast: return FastDesign::makePeakPrewarped((float) g, quality, FastDesign::decibelsToAmplitude<Accuracy::fast>(gainInDecibels, 40.f)).template as<SampleType>();
+            case Accuracy::exact:
+            default:             return makePeakSVF<SampleType>(g, quality, std::pow(10.0, gainInDecibels / 40.0));
+        }
+    }
+
+    bool isOnChannel(int band, int channel) const noexcept
+    {
+        return (bandChannels[(size_t) band] & ChannelRoles::getChannelBit(channel)) != 0;
+    }
+
+    void setLane(int band, int channel, const Coefficients& c) noexcept
+    {
+        auto& lanes = groupCoefficients[(size_t) ((channel / laneWidth) * numSections + band)];
+        auto lane = channel % laneWidth;
+
+        lanes.a1[lane] = c.a1;
+        lanes.a2[lane] = c.a2;
+        lanes.a3[lane] = c.a3;
+        lanes.m0[lane] = c.m0;
+        lanes.m1[lane] = c.m1;
+        lanes.m2[lane] = c.m2;
+    }
+
+    // Cut sections run on every channel
+    void setSectionCoefficients(int section, const Coefficients& c) noexcept
+    {
+        ++numCoefficientUpdates;
+
+        for (int channel = 0; channel < numGroups * laneWidth; ++channel)
+            setLane(section, channel, c);
+    }
+
+    // One design for every channel the band is on; spare lanes and the other channels pass through
+    void setBandCoefficients(int band, const Coefficients& c) noexcept
+    {
+        ++numCoefficientUpdates;
+
+        for (int channel = 0; channel < numGroups * laneWidth; ++channel)
+            setLane(band, channel, isOnChannel(band, channel) ? c : Coefficients{});
+    }
+
+    // Linked, a dynamic band has one gain for all its channels; otherwise each channel follows its own
+    template <typename Design>
+    void setDynamicCoefficients(int band, Design&& design) noexcept
+    {
+        if (channelLayout == FeatherParameters::linked)
+        {
+            setBandCoefficients(band, design(dynamicGains[(size_t) band]));
+            return;
+        }
+
+        for (int channel = 0; channel < numGroups * laneWidth; ++channel)
+        {
+            if (! isOnChannel(band, channel))
+            {
+                setLane(band, channel, {});
+                continue;
+            }
+
+            ++numCoefficientUpdates;
+            setLane(band, channel, design(channelDynamicGains[(size_t) (channel * numBands + band)]));
+        }
+    }
+
+    //==============================================================================
+    juce::uint64 getPlacementChannels(int placement) const noexcept
+    {
+        auto all = ChannelRoles::getAllChannels(numChannels);
+
+        if (placement == FeatherParameters::allChannels)
+            return all;
+
+        switch (channelLayout)
+        {
+            case FeatherParameters::independent:
+                return (placement == FeatherParameters::leftOrMid ? roles.leftChannels : roles.rightChannels) & all;
+
+            case FeatherParameters::midSide:
+                return ChannelRoles::getChannelBit(placement == FeatherParameters::leftOrMid ? roles.midChannel : roles.sideChannel) & all;
+
+            case FeatherParameters::linked:
+            default:
+                return all;
+        }
+    }
+
+    // Works out the channel masks and detectors for the mode and roles, and redesigns every band.
+    // Mid/side needs a front pair; without one it places bands as independent does.
+    void rebuildChannelLayout() noexcept
+    {
+        channelLayout = channelMode;
+
+        if (channelLayout == FeatherParameters::midSide
+            && ! (roles.hasMidSidePair() && juce::jmax(roles.midChannel, roles.sideChannel) < numChannels))
+            channelLayout = FeatherParameters::independent;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            bandChannels[(size_t) band] = getPlacementChannels(placements[(size_t) band]);
+            clearDynamicGains(band);
+        }
+
+        rebuildDynamicBands();
+        setDetectorTimes();
+
+        dynamics.reset();
+
+        for (auto& detector : channelDetectors)
+            detector.reset();
+
+        for (int band = 0; band < numBands; ++band)
+            updateBandCoefficients(band);
+
+        rebuildActiveBands();
+    }
+
+    //==============================================================================
+    // Linked uses the one detector on the mono sum, the other modes one per channel
+    template <typename Function>
+    void forEachDetector(Function&& function) noexcept
+    {
+        if (channelLayout == FeatherParameters::linked)
+        {
+            function(dynamics);
+            return;
+        }
+
+        for (auto& detector : channelDetectors)
+            function(detector);
+    }
+
+    void setDetectorTimes() noexcept
+    {
+        forEachDetector([this](DynamicsDetector<NumBands>& detector)
+        {
+            detector.setTimes(sampleRate / controlInterval, attackMs, releaseMs);
+        });
+    }
+
+    void setDetectorBand(int band, double g, float quality) noexcept
+    {
+        forEachDetector([&](DynamicsDetector<NumBands>& detector)
+        {
+            detector.setBand(dynamicSlots[(size_t) band], g, quality, thresholds[(size_t) band], ratios[(size_t) band]);
+        });
+    }
+
+    void clearDynamicGains(int band) noexcept
+    {
+        dynamicGains[(size_t) band] = 0.f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            channelDynamicGains[(size_t) (channel * numBands + band)] = 0.f;
+    }
+
+    void rebuildDynamicBands() noexcept
+    {
+        std::array<int, (size_t) NumBands> bands;
+        int numDynamic = 0;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            dynamicSlots[(size_t) band] = bandIsDynamic[(size_t) band] ? numDynamic : -1;
+
+            if (bandIsDynamic[(size_t) band])
+                bands[(size_t) numDynamic++] = band;
+        }
+
+        numDynamicBands = numDynamic;
+        dynamicChannels = 0;
+
+        forEachDetector([&](DynamicsDetector<NumBands>& detector) { detector.setBands(bands.data(), numDynamic); });
+
+        for (int slot = 0; slot < numDynamic; ++slot)
+        {
+            auto band = bands[(size_t) slot];
+            setDetectorBand(band, prewarpedFreqs[(size_t) band], smoothers[(size_t) band].quality.getCurrentValue());
+            dynamicChannels |= bandChannels[(size_t) band];
+        }
+    }
+
+    void accumulateSidechain(const juce::dsp::AudioBlock<SampleType>& block, size_t startSample, int numSamples) noexcept
+    {
+        auto channelsToUse = juce::jmin((int) block.getNumChannels(), numChannels);
+
+        if (channelsToUse == 0)
+            return;
+
+        if (channelLayout != FeatherParameters::linked)
+        {
+            // Only channels that some dynamic band is on need listening to
+            for (int channel = 0; channel < channelsToUse; ++channel)
+                if ((dynamicChannels & ChannelRoles::getChannelBit(channel)) != 0)
+                    channelDetectors[(size_t) channel].accumulate(block.getChannelPointer((size_t) channel) + startSample, numSamples);
+
+            return;
+        }
+
+        auto* mono = sidechain.data();
+        auto gain = (SampleType) 1 / (SampleType) channelsToUse;
+
+        // In chunks, so the buffer's size doesn't depend on the control interval, which can change after prepare()
+        for (int done = 0; done < numSamples;)
+        {
+            auto numThisTime = juce::jmin(maxChunkSize, numSamples - done);
+            auto offset = startSample + (size_t) done;
+
+            juce::FloatVectorOperations::copyWithMultiply(mono, block.getChannelPointer(0) + offset, gain, numThisTime);
+
+            for (int channel = 1; channel < channelsToUse; ++channel)
+                juce::FloatVectorOperations::addWithMultiply(mono, block.getChannelPointer((size_t) channel) + offset, gain, numThisTime);
+
+            dynamics.accumulate(mono, numThisTime);
+            done += numThisTime;
+        }
+    }
+
+    // A cut goes down as far as its gain, a boost up as far as its gain
+    float getDynamicGain(int band, float amount) const noexcept
+    {
+        auto depth = smoothers[(size_t) band].gainInDecibels.getCurrentValue();
+        return depth < 0.f ? juce::jmax(depth, -amount) : juce::jmin(depth, amount);
+    }
+
+    void updateDynamics() noexcept
+    {
+        if (channelLayout == FeatherParameters::linked)
+        {
+            dynamics.update([this](int band, float amount)
+            {
+                auto gain = getDynamicGain(band, amount);
+
+                if (gain == dynamicGains[(size_t) band])
+                    return;
+
+                dynamicGains[(size_t) band] = gain;
+                setBandCoefficients(band, makeMovingPeak(prewarpedFreqs[(size_t) band], smoothers[(size_t) band].quality.getCurrentValue(), gain));
+            });
+
+            return;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if ((dynamicChannels & ChannelRoles::getChannelBit(channel)) == 0)
+                continue;
+
+            channelDetectors[(size_t) channel].update([this, channel](int band, float amount)
+            {
+                if (! isOnChannel(band, channel))
+                    return;
+
+                auto gain = getDynamicGain(band, amount);
+                auto& current = channelDynamicGains[(size_t) (channel * numBands + band)];
+
+                if (gain == current)
+                    return;
+
+                current = gain;
+                ++numCoefficientUpdates;
+                setLane(band, channel, makeMovingPeak(prewarpedFreqs[(size_t) band], smoothers[(size_t) band].quality.getCurrentValue(), gain));
+            });
+        }
+    }
+
+    void advanceSmoothing() noexcept
+    {
+        for (int i = 0; i < numSmoothingBands; ++i)
+        {
+            auto& smoother = smoothers[(size_t) smoothingBands[(size_t) i]];
+
+            smoother.freq.getNextValue();
+            smoother.gainInDecibels.getNextValue();
+            smoother.quality.getNextValue();
+        }
+
+        auto exact = designAccuracy == FastDesign::Accuracy::exact;
+
+        if (exact)
+        {
+            for (int i = 0; i < numSmoothingBands; ++i)
+                updateBandCoefficients(smoothingBands[(size_t) i]);
+        }
+        else
+        {
+            designSmoothingBands();
+        }
+
+        for (int i = 0; i < numSmoothingBands;)
+        {
+            auto band = smoothingBands[(size_t) i];
+
+            if (isSmoothing(smoothers[(size_t) band]))
+            {
+                ++i;
+                continue;
+            }
+
+            // Finished: land exactly on the target, swap-remove from the list, and drop the band if it has landed on 0 dB.
+            // Its decay no longer needs to cover where the ramp started.
+            if (! exact)
+                updateBandCoefficients(band);
+
+            updateBandDecay(band);
+
+            bandIsSmoothing[(size_t) band] = false;
+            smoothingBands[(size_t) i] = smoothingBands[(size_t) --numSmoothingBands];
+            updateActivity(band);
+        }
+    }
+
+    // Designs every ramping band in one batch, struct-of-arrays, so the maths vectorises across bands
+    void designSmoothingBands() noexcept
+    {
+        auto& batch = designBatch;
+        auto numToDesign = numSmoothingBands;
+
+        for (int i = 0; i < numToDesign; ++i)
+        {
+            auto band = smoothingBands[(size_t) i];
+            const auto& smoother = smoothers[(size_t) band];
+
+            batch.normalisedFreqs[(size_t) i] = (float) (smoother.freq.getCurrentValue() / sampleRate);
+            batch.qualities[(size_t) i] = smoother.quality.getCurrentValue();
+            batch.gains[(size_t) i] = bandIsDynamic[(size_t) band] ? dynamicGains[(size_t) band]
+                                                                   : smoother.gainInDecibels.getCurrentValue();
+        }
+
+        if (designAccuracy == FastDesign::Accuracy::high)
+            batch.template design<FastDesign::Accuracy::high>(numToDesign);
+        else
+            batch.template design<FastDesign::Accuracy::fast>(numToDesign);
+
+        for (int i = 0; i < numToDesign; ++i)
+        {
+            auto band = smoothingBands[(size_t) i];
+            auto g = batch.g[(size_t) i];
+
+            prewarpedFreqs[(size_t) band] = g;
+
+            if (bandIsDynamic[(size_t) band])
+            {
+                auto quality = batch.qualities[(size_t) i];
+                setDetectorBand(band, g, quality);
+
+                // The batch designed the linked gain; per-channel gains are designed one by one
+                if (channelLayout != FeatherParameters::linked)
+                {
+                    setDynamicCoefficients(band, [this, g, quality](float gain) { return makeMovingPeak(g, quality, gain); });
+                    continue;
+                }
+            }
+
+            setBandCoefficients(band, batch.get(i).template as<SampleType>());
+        }
+    }
+
+    // In place on the front pair: mid = (L + R) / 2, side = (L - R) / 2, and back again after the bands
+    void encodeMidSide(juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        auto* mid = block.getChannelPointer((size_t) roles.midChannel);
+        auto* side = block.getChannelPointer((size_t) roles.sideChannel);
+
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
+        {
+            auto left = mid[i], right = side[i];
+            mid[i] = (SampleType) 0.5 * (left + right);
+            side[i] = (SampleType) 0.5 * (left - right);
+        }
+    }
+
+    void decodeMidSide(juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        auto* left = block.getChannelPointer((size_t) roles.midChannel);
+        auto* right = block.getChannelPointer((size_t) roles.sideChannel);
+
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
+        {
+            auto mid = left[i], side = right[i];
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    void processSubBlock(juce::dsp::AudioBlock<SampleType>& block, size_t startSample, int numSamples) noexcept
+    {
+        auto channelsToProcess = juce::jmin((int) block.getNumChannels(), numChannels);
+
+        for (int group = 0; group < numGroups; ++group)
+        {
+            auto firstChannel = group * laneWidth;
+            auto channelsInGroup = juce::jmin(laneWidth, channelsToProcess - firstChannel);
+
+            if (channelsInGroup <= 0)
+                break;
+
+            auto* states = groupStates.data() + group * numSections;
+            auto* coefficients = groupCoefficients.data() + group * numSections;
+
+            for (int done = 0; done < numSamples;)
+            {
+                auto numThisTime = juce::jmin(maxChunkSize, numSamples - done);
+                auto offset = startSample + (size_t) done;
+
+                if (laneWidth == 1)
+                {
+                    // One lane: the channel itself is already "interleaved"
+                    kernel(coefficients, states, activeSections.data(), numActiveSections,
+                           block.getChannelPointer((size_t) firstChannel) + offset, numThisTime);
+                }
+                else
+                {
+                    auto* frames = interleaved.data();
+
+                    for (int lane = 0; lane < channelsInGroup; ++lane)
+                    {
+                        auto* source = block.getChannelPointer((size_t) (firstChannel + lane)) + offset;
+
+                        for (int i = 0; i < numThisTime; ++i)
+                            frames[i * laneWidth + lane] = source[i];
+                    }
+
+                    // Spare lanes are zero from prepare() unless an earlier, fuller group has used them
+                    if (numGroups > 1)
+                        for (int lane = channelsInGroup; lane < laneWidth; ++lane)
+                            for (int i = 0; i < numThisTime; ++i)
+                                frames[i * laneWidth + lane] = SampleType();
+
+                    kernel(coefficients, states, activeSections.data(), numActiveSections, frames, numThisTime);
+
+                    for (int lane = 0; lane < channelsInGroup; ++lane)
+                    {
+                        auto* dest = block.getChannelPointer((size_t) (firstChannel + lane)) + offset;
+
+                        for (int i = 0; i < numThisTime; ++i)
+                            dest[i] = frames[i * laneWidth + lane];
+                    }
+                }
+
+                done += numThisTime;
+            }
+        }
+    }
+
+    // Frames per kernel call when lanes are interleaved, and per sidechain mixdown; keeps the scratch buffers inside L1.
+    static constexpr int maxChunkSize = 256;
+
+    std::array<BandSmoother, (size_t) NumBands> smoothers;
+    std::vector<Cascade::LaneCoefficients<SampleType>> groupCoefficients;   // numSections per lane group, group-major
+    std::vector<Cascade::LaneState<SampleType>> groupStates;                // laid out the same way
+    std::vector<SampleType> interleaved;
+    std::vector<SampleType> sidechain;             // mono detector input, maxChunkSize long
+
+    std::array<int, (size_t) NumBands> smoothingBands{};
+    std::array<int, (size_t) numSections> activeSections{};
+    std::array<bool, (size_t) NumBands> bandIsSmoothing{}, bandIsActive{};
+    int numSmoothingBands{ 0 }, numActiveBands{ 0 }, numActiveSections{ 0 };
+
+    struct CutStage
+    {
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freq{ CutSettings().freq };
+        int numSections{ 0 };
+    };
+
+    std::array<CutStage, (size_t) FeatherParameters::numCutTypes> cuts;
+
+    struct DesignBatch
+    {
+        template <FastDesign::Accuracy accuracy>
+        void design(int numToDesign) noexcept
+        {
+            FastDesign::prewarp<accuracy>(normalisedFreqs.data(), g.data(), numToDesign);
+            FastDesign::makePeaksPrewarped<accuracy>(g.data(), qualities.data(), gains.data(),
+                                                     { a1.data(), a2.data(), a3.data(), m0.data(), m1.data(), m2.data() },
+                                                     numToDesign);
+        }
+
+        SVFCoefficients get(int i) const noexcept
+        {
+            return { a1[(size_t) i], a2[(size_t) i], a3[(size_t) i], m0[(size_t) i], m1[(size_t) i], m2[(size_t) i] };
+        }
+
+        std::array<float, (size_t) NumBands> normalisedFreqs{}, qualities{}, gains{}, g{};
+        std::array<float, (size_t) NumBands> a1{}, a2{}, a3{}, m0{}, m1{}, m2{};
+    };
+
+    DesignBatch designBatch;
+    FastDesign::Accuracy designAccuracy{ FastDesign::Accuracy::high };
+
+    DynamicsDetector<NumBands> dynamics;                         // linked
+    std::vector<DynamicsDetector<NumBands>> channelDetectors;    // one per channel otherwise
+    std::array<double, (size_t) NumBands> prewarpedFreqs{};
+    std::array<float, (size_t) NumBands> thresholds{}, ratios{}, dynamicGains{};
+    std::vector<float> channelDynamicGains;                      // numBands per channel, channel-major
+    std::array<int, (size_t) NumBands> dynamicSlots{};
+    std::array<bool, (size_t) NumBands> bandIsDynamic{};
+    int numDynamicBands{ 0 };
+    juce::uint64 dynamicChannels{ 0 };                          // channels any dynamic band is on
+
+    ChannelRoles roles;
+    int channelMode{ FeatherParameters::linked }, channelLayout{ FeatherParameters::linked };   // requested, and in use
+    std::array<int, (size_t) NumBands> placements{};
+    std::array<juce::uint64, (size_t) NumBands> bandChannels{};
+    float attackMs{ 5.f }, releaseMs{ 100.f };
+
+    std::optional<Cascade::KernelType> requestedKernelType;
+    Cascade::KernelType kernelType{ Cascade::KernelType::scalar };
+    Cascade::KernelFunction<SampleType> kernel{ nullptr };
+    int laneWidth{ 1 }, numChannels{ 0 }, numGroups{ 0 };
+
+    double sampleRate{ 44100.0 };
+    double smoothingTimeSeconds{ 0.05 };
+    int controlInterval{ defaultControlInterval };
+    int samplesUntilControlTick{ 0 };
+    std::array<double, (size_t) NumBands> bandDecaySeconds{};
+    std::array<double, (size_t) FeatherParameters::numCutTypes> cutDecaySeconds{};
+    double tailSeconds{ 0.0 };
+    bool tailIsStale{ true };
+    juce::int64 numCoefficientUpdates{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeatherEngine)
+};
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    FeatherParameters.h
+
+    Band parameters, settings and their IDs, generated from the band count.
+    Band indices are zero-based in code; parameter IDs count from 1
+    ("Freq 1", "Gain 1", "Q 1", "Threshold 1", "Ratio 1", "Placement 1",
+    ...), as they always have, so sessions saved with four bands still load.
+
+    The low- and high-cut filters either side of the bands have their own
+    settings and parameters ("LowCut Freq", "LowCut Slope", ...), which
+    default to off.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct BandSettings
+{
+    float freq{ 1000.f }, gainInDecibels{ 0.f }, quality{ 1.f };
+
+    // With a ratio above 1 the band is dynamic: its gain is the most it will cut or boost, and
+    // it only gets there as the level in the band rises past the threshold.
+    float thresholdInDecibels{ 0.f }, ratio{ 1.f };
+
+    // Which channels the band runs on, a FeatherParameters::Placement
+    int placement{ 0 };
+
+    bool isDynamic() const noexcept  { return ratio > 1.f && gainInDecibels != 0.f; }
+};
+
+// A low- or high-cut filter. The slope is a FeatherParameters::CutSlope; off leaves it out of the cascade.
+struct CutSettings
+{
+    float freq{ 20.f };
+    int slope{ 0 };
+
+    bool operator==(const CutSettings& other) const noexcept  { return freq == other.freq && slope == other.slope; }
+    bool operator!=(const CutSettings& other) const noexcept  { return ! operator==(other); }
+};
+
+template <int NumBands>
+struct ChainSettings
+{
+    static_assert(NumBands > 0, "A feathering bank needs at least one band");
+
+    static constexpr int numBands = NumBands;
+
+    std::array<BandSettings, (size_t) NumBands> bands;
+};
+
+namespace FeatherParameters
+{
+    constexpr const char* phaseModeID = "Phase Mode";
+    constexpr const char* kernelLengthID = "Kernel Length";
+    constexpr const char* oversamplingID = "Oversampling";
+    constexpr const char* oversamplingFilterID = "Oversampling Filter";
+    constexpr const char* snapshotMorphID = "Snapshot Morph";
+    constexpr const char* morphID = "Morph";
+    constexpr const char* attackID = "Attack";
+    constexpr const char* releaseID = "Release";
+    constexpr const char* channelModeID = "Channel Mode";
+    constexpr const char* lowCutFreqID = "LowCut Freq";
+    constexpr const char* lowCutSlopeID = "LowCut Slope";
+    constexpr const char* highCutFreqID = "HighCut Freq";
+    constexpr const char* highCutSlopeID = "HighCut Slope";
+
+    enum PhaseMode
+    {
+        minimumPhase,
+        linearPhase
+    };
+
+    // Linked runs every band on every channel with one shared level detector. Independent gives
+    // each channel its own detector and lets bands sit on the left or right channels only.
+    // Mid/side does the same on the mid and side of the front pair.
+    enum ChannelMode
+    {
+        linked,
+        independent,
+        midSide
+    };
+
+    enum Placement
+    {
+        allChannels,
+        leftOrMid,
+        rightOrSide
+    };
+
+    enum CutType
+    {
+        lowCut,
+        highCut,
+        numCutTypes
+    };
+
+    // Butterworth slopes in dB/oct, each 12 dB/oct one more second-order section
+    enum CutSlope
+    {
+        cutOff,
+        slope12,
+        slope24,
+        slope36,
+        slope48,
+        slope72,
+        slope96,
+        numCutSlopes
+    };
+
+    inline juce::StringArray getCutSlopeNames()  { return { "Off", "12 dB/oct", "24 dB/oct", "36 dB/oct", "48 dB/oct", "72 dB/oct", "96 dB/oct" }; }
+
+    inline juce::String getFreqID(int band)       { return "Freq " + juce::String(band + 1); }
+    inline juce::String getGainID(int band)       { return "Gain " + juce::String(band + 1); }
+    inline juce::String getQualityID(int band)    { return "Q " + juce::String(band + 1); }
+    inline juce::String getThresholdID(int band)  { return "Threshold " + juce::String(band + 1); }
+    inline juce::String getRatioID(int band)      { return "Ratio " + juce::String(band + 1); }
+    inline juce::String getPlacementID(int band)  { return "Placement " + juce::String(band + 1); }
+
+    // Spreads the default centre frequencies 250 Hz apart, which gives the original 250/500/750/1000 Hz for four bands.
+    inline float getDefaultFreq(int band)         { return juce::jmin(20000.f, 250.f * (float) (band + 1)); }
+
+    template <int NumBands>
+    void addBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+    {
+        for (int band = 0; band < NumBands; ++band)
+        {
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getFreqID(band),
+                                                                   getFreqID(band),
+                                                                   juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                                   getDefaultFreq(band)));
+
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getGainID(band),
+                                                                   getGainID(band),
+                                                                   juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                                   0.0f));
+
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getQualityID(band),
+                                                                   getQualityID(band),
+                                                                   juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                                   1.f));
+
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getThresholdID(band),
+                                                                   getThresholdID(band),
+                                                                   juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+                                                                   -24.f));
+
+            // 1:1 leaves the band static
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getRatioID(band),
+                                                                   getRatioID(band),
+                                                                   juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.5f),
+                                                                   1.f));
+
+            layout.add(std::make_unique<juce::AudioParameterChoice>(getPlacementID(band),
+                                                                    getPlacementID(band),
+                                                                    juce::StringArray{ "All", "Left / Mid", "Right / Side" },
+                                                                    allChannels));
+        }
+    }
+
+    inline void addCutParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+    {
+        for (auto [freqID, slopeID, defaultFreq] : { std::make_tuple(lowCutFreqID, lowCutSlopeID, 20.f),
+                                                     std::make_tuple(highCutFreqID, highCutSlopeID, 20000.f) })
+        {
+            layout.add(std::make_unique<juce::AudioParameterFloat>(freqID,
+                                                                   freqID,
+                                                                   juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                                   defaultFreq));
+
+            layout.add(std::make_unique<juce::AudioParameterChoice>(slopeID,
+                                                                    slopeID,
+                                                                    getCutSlopeNames(),
+                                                                    cutOff));
+        }
+    }
+}
+
+using CutSettingsArray = std::array<CutSettings, (size_t) FeatherParameters::numCutTypes>;
+
+template <int NumBands>
+ChainSettings<NumBands> getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    ChainSettings<NumBands> settings;
+
+    for (int band = 0; band < NumBands; ++band)
+    {
+        auto& bandSettings = settings.bands[(size_t) band];
+
+        bandSettings.freq = apvts.getRawParameterValue(FeatherParameters::getFreqID(band))->load();
+        bandSettings.gainInDecibels = apvts.getRawParameterValue(FeatherParameters::getGainID(band))->load();
+        bandSettings.quality = apvts.getRawParameterValue(FeatherParameters::getQualityID(band))->load();
+        bandSettings.thresholdInDecibels = apvts.getRawParameterValue(FeatherParameters::getThresholdID(band))->load();
+        bandSettings.ratio = apvts.getRawParameterValue(FeatherParameters::getRatioID(band))->load();
+        bandSettings.placement = juce::roundToInt(apvts.getRawParameterValue(FeatherParameters::getPlacementID(band))->load());
+    }
+
+    return settings;
+}
+
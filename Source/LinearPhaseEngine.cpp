@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEngine.h"
+#include "CutFilter.h"
+
+namespace
+{
+    // Magnitude of the analogue bell prototype. Designing from the prototype rather than the
+    // bilinear-transformed filter means bands near Nyquist keep their true shape here.
+    double getAnaloguePeakMagnitude(const BandSettings& band, double frequency)
+    {
+        auto A = std::pow(10.0, band.gainInDecibels / 40.0);
+        auto w = frequency / band.freq;        // normalised so the centre sits at 1
+        auto offCentre = juce::square(1.0 - w * w);
+        auto numeratorBandwidth = juce::square(w * A / band.quality);
+        auto denominatorBandwidth = juce::square(w / (A * band.quality));
+
+        return std::sqrt((offCentre + numeratorBandwidth) / (offCentre + denominatorBandwidth));
+    }
+
+    // Magnitude of a cut's analogue Butterworth prototype: 1 / sqrt(1 + r^(2n)) for order n, with
+    // r = f / fc for the high cut and fc / f for the low cut
+    double getAnalogueCutMagnitude(int cut, const CutSettings& settings, double frequency)
+    {
+        auto order = 2 * CutFilter::getNumSections(settings.slope);
+        auto ratio = cut == FeatherParameters::lowCut ? settings.freq / frequency : frequency / settings.freq;
+
+        return order > 0 ? 1.0 / std::sqrt(1.0 + std::pow(ratio, 2 * order)) : 1.0;
+    }
+}
+
+LinearPhaseEngine::LinearPhaseEngine(int numBands, SettingsSource source)
+    : settingsSource(std::move(source)),
+      bandSettings((size_t) numBands)
+{
+    backgroundThread->addTimeSliceClient(this);
+}
+
+LinearPhaseEngine::~LinearPhaseEngine()
+{
+    backgroundThread->removeTimeSliceClient(this);
+}
+
+void LinearPhaseEngine::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    {
+        const juce::ScopedLock sl(convolutionLock);
+
+        auto numPairs = juce::jmax(1, ((int) spec.numChannels + 1) / 2);
+        convolutions.resize((size_t) numPairs);
+
+        auto pairSpec = spec;
+        pairSpec.numChannels = juce::jmin(spec.numChannels, (juce::uint32) 2);
+
+        for (auto& convolution : convolutions)
+        {
+            if (convolution == nullptr)
+                convolution = std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::Latency{ 0 }, *convolutionQueue);
+
+            convolution->prepare(pairSpec);
+        }
+    }
+
+    conversionBuffer.setSize((int) spec.numChannels, (int) spec.maximumBlockSize);
+
+    sampleRate.store(spec.sampleRate);
+    requestKernelUpdate();
+    backgroundThread->moveToFrontOfQueue(this);
+}
+
+void LinearPhaseEngine::reset() noexcept
+{
+    for (auto& convolution : convolutions)
+        convolution->reset();
+}
+
+bool LinearPhaseEngine::isKernelInstalled() const noexcept
+{
+    if (convolutions.empty() || numKernelBuilds.load() == 0)
+        return false;
+
+    for (auto& convolution : convolutions)
+        if (convolution->getCurrentIRSize() != kernelLength.load())
+            return false;
+
+    return true;
+}
+
+void LinearPhaseEngine::setKernelLength(int newKernelLength) noexcept
+{
+    jassert(std::find(kernelLengths.begin(), kernelLengths.end(), newKernelLength) != kernelLengths.end());
+
+    if (kernelLength.exchange(newKernelLength) != newKernelLength)
+        requestKernelUpdate();
+}
+
+void LinearPhaseEngine::process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    auto numChannels = block.getNumChannels();
+
+    for (size_t pair = 0; pair < convolutions.size() && pair * 2 < numChannels; ++pair)
+    {
+        auto pairBlock = block.getSubsetChannelBlock(pair * 2, juce::jmin((size_t) 2, numChannels - pair * 2));
+        convolutions[pair]->process(juce::dsp::ProcessContextReplacing<float>(pairBlock));
+    }
+}
+
+void LinearPhaseEngine::process(const juce::dsp::ProcessContextReplacing<double>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    auto numChannels = juce::jmin(block.getNumChannels(), (size_t) conversionBuffer.getNumChannels());
+    auto chunkSize = (size_t) conversionBuffer.getNumSamples();
+
+    for (size_t start = 0; start < block.getNumSamples() && chunkSize > 0; start += chunkSize)
+    {
+        auto numSamples = juce::jmin(chunkSize, block.getNumSamples() - start);
+        auto chunk = block.getSubBlock(start, numSamples).getSubsetChannelBlock(0, numChannels);
+        auto floatChunk = juce::dsp::AudioBlock<float>(conversionBuffer).getSubBlock(0, numSamples)
+                                                                        .getSubsetChannelBlock(0, numChannels);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* samples = chunk.getChannelPointer(channel);
+            auto* floatSamples = floatChunk.getChannelPointer(channel);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                floatSamples[i] = (float) samples[i];
+        }
+
+        process(juce::dsp::ProcessContextReplacing<float>(floatChunk));
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* samples = chunk.getChannelPointer(channel);
+            auto* floatSamples = floatChunk.getChannelPointer(channel);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                samples[i] = (double) floatSamples[i];
+        }
+    }
+}
+
+int LinearPhaseEngine::useTimeSlice()
+{
+    // Poll rather than be woken: signalling the thread from processBlock would take a lock
+    constexpr int pollIntervalMs = 20;
+
+    auto rate = sampleRate.load();
+
+    if (rate <= 0.0 || ! kernelIsStale.exchange(false))
+        return pollIntervalMs;
+
+    settingsSource(bandSettings, cutSettings);
+
+    auto length = kernelLength.load();
+    juce::AudioBuffer<float> kernel(1, length);
+
+    designKernel(bandSettings, cutSettings, rate, length, kernel.getWritePointer(0));
+
+    const juce::ScopedLock sl(convolutionLock);
+
+    for (auto& convolution : convolutions)
+    {
+        juce::AudioBuffer<float> copy(kernel);
+        convolution->loadImpulseResponse(std::move(copy), rate,
+                                         juce::dsp::Convolution::Stereo::no,
+                                         juce::dsp::Convolution::Trim::no,
+                                         juce::dsp::Convolution::Normalise::no);
+    }
+
+    ++numKernelBuilds;
+    return pollIntervalMs;
+}
+
+void LinearPhaseEngine::designKernel(const std::vector<BandSettings>& bands, const CutSettingsArray& cuts,
+                                     double rate, int length, float* kernel)
+{
+    jassert(juce::isPowerOfTwo(length));
+
+    auto order = 0;
+    while ((1 << order) < length)
+        ++order;
+
+    juce::dsp::FFT fft(order);
+
+    // performRealOnlyInverseTransform wants 2 * length floats: bins 0..length/2 as re/im pairs in, samples out
+    std::vector<float> spectrum((size_t) (2 * length), 0.f);
+
+    for (int bin = 0; bin <= length / 2; ++bin)
+    {
+        auto frequency = bin * rate / length;
+        auto magnitude = 1.0;
+
+        for (const auto& band : bands)
+            if (band.gainInDecibels != 0.f)
+                magnitude *= getAnaloguePeakMagnitude(band, juce::jmax(frequency, 1.0));
+
+        for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+            magnitude *= getAnalogueCutMagnitude(cut, cuts[(size_t) cut], juce::jmax(frequency, 1.0));
+
+        // Zero phase: purely real bins
+        spectrum[(size_t) (2 * bin)] = (float) magnitude;
+    }
+
+    // Sample 0 of the zero-phase response is the mean over the whole (mirrored) spectrum. Unlike
+    // the DC gain, that's never 0, so it still pins the scale down under a low cut.
+    auto spectrumSum = (double) spectrum[0] + (double) spectrum[(size_t) length];
+
+    for (int bin = 1; bin < length / 2; ++bin)
+        spectrumSum += 2.0 * spectrum[(size_t) (2 * bin)];
+
+    fft.performRealOnlyInverseTransform(spectrum.data());
+
+    // The zero-phase response wraps around sample 0. Normalise it independently of the FFT's
+    // scaling convention, then rotate it to the kernel's centre.
+    auto scale = spectrum[0] != 0.f ? (float) (spectrumSum / length / spectrum[0]) : 1.f;
+
+    for (int i = 0; i < length; ++i)
+        kernel[(i + length / 2) % length] = spectrum[(size_t) i] * scale;
+
+    // Taper the ends so truncating the response doesn't ring
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(spectrum.data(), (size_t) length,
+                                                              juce::dsp::WindowingFunction<float>::blackman, false);
+    juce::FloatVectorOperations::multiply(kernel, spectrum.data(), length);
+}
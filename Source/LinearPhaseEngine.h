@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.h
+
+    Linear-phase alternative to the FeatherEngine. The combined magnitude
+    response of all bands is turned into a symmetric FIR kernel, which runs
+    through juce::dsp::Convolution's uniformly partitioned FFT convolution.
+
+    Kernels are designed on the shared background thread and handed to the
+    Convolution, which swaps them in without locking the audio thread and
+    crossfades from the old kernel to the new one. The audio thread only
+    raises a flag when the bands change.
+
+    The kernel is centred, so the engine's latency is half the kernel length.
+
+    A Convolution handles at most two channels, so there is one per pair of
+    channels in the layout, all running the same kernel. Every band applies
+    to every channel here; placements and mid/side are for the minimum-phase
+    engine only. The cut filters are the analogue Butterworth magnitudes.
+
+    Convolution only runs in float, so double-precision blocks go through
+    a float copy. A kernel this long is no more accurate than float anyway.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BackgroundThread.h"
+#include "FeatherParameters.h"
+
+class LinearPhaseEngine  : private juce::TimeSliceClient
+{
+public:
+    // Kernel lengths on offer, shortest first. Longer kernels resolve low frequencies better
+    // at the cost of CPU and latency.
+    static constexpr std::array<int, 5> kernelLengths{ 1024, 2048, 4096, 8192, 16384 };
+    static constexpr int defaultKernelLengthIndex = 2;
+
+    // Fills in the current settings of every band and both cut filters. Called on the background
+    // thread, so it must only read thread-safe state such as the APVTS raw parameter values.
+    using SettingsSource = std::function<void(std::vector<BandSettings>&, CutSettingsArray&)>;
+
+    LinearPhaseEngine(int numBands, SettingsSource settingsSource);
+    ~LinearPhaseEngine() override;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    // Safe to call from the audio thread; the kernel is rebuilt on the background thread.
+    void setKernelLength(int newKernelLength) noexcept;
+    int getKernelLength() const noexcept { return kernelLength.load(); }
+
+    int getLatencySamples() const noexcept { return getKernelLength() / 2; }
+
+    // Flags the kernel as stale. Lock-free, so the audio thread can call it whenever bands change.
+    void requestKernelUpdate() noexcept { kernelIsStale.store(true); }
+
+    // True once every Convolution is running a kernel of the current length. Audio thread, like process().
+    bool isKernelInstalled() const noexcept;
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept;
+    void process(const juce::dsp::ProcessContextReplacing<double>& context) noexcept;
+
+    // Running total of kernels designed on the background thread, for the performance monitor
+    juce::int64 getNumKernelBuilds() const noexcept { return numKernelBuilds.load(); }
+
+    // Designs a linear-phase kernel for the given bands and cuts into kernel, which must hold
+    // length samples. Exposed so the benchmark can time it without a Convolution.
+    static void designKernel(const std::vector<BandSettings>& bands, const CutSettingsArray& cuts,
+                             double sampleRate, int length, float* kernel);
+
+private:
+    int useTimeSlice() override;
+
+    juce::SharedResourcePointer<SharedBackgroundThread> backgroundThread;
+    juce::SharedResourcePointer<juce::dsp::ConvolutionMessageQueue> convolutionQueue;
+
+    // Created in prepare(); the lock keeps the background thread off them while that happens
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+    juce::CriticalSection convolutionLock;
+
+    // Float copy of a double-precision block
+    juce::AudioBuffer<float> conversionBuffer;
+
+    SettingsSource settingsSource;
+    std::vector<BandSettings> bandSettings;
+    CutSettingsArray cutSettings{};
+
+    std::atomic<double> sampleRate{ 0.0 };
+    std::atomic<int> kernelLength{ kernelLengths[(size_t) defaultKernelLengthIndex] };
+    std::atomic<bool> kernelIsStale{ true };
+    std::atomic<juce::int64> numKernelBuilds{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseEngine)
+};
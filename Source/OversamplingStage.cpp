@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    OversamplingStage.cpp
+
+  ==============================================================================
+*/
+
+#include "OversamplingStage.h"
+
+template <typename SampleType>
+void OversamplingStage::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+
+    // Only one precision runs at a time
+    if constexpr (std::is_same_v<SampleType, double>)
+        floatOversamplers = {};
+    else
+        doubleOversamplers = {};
+
+    for (int type = 0; type < numFilterTypes; ++type)
+    {
+        auto oversamplerType = type == polyphaseIIR ? Oversampler<SampleType>::filterHalfBandPolyphaseIIR
+                                                    : Oversampler<SampleType>::filterHalfBandFIREquiripple;
+
+        for (int factor = 1; factor <= maxFactor; ++factor)
+        {
+            // Integer latency so the host can compensate exactly
+            auto& oversampler = getOversamplers<SampleType>()[(size_t) type][(size_t) factor - 1];
+            oversampler = std::make_unique<Oversampler<SampleType>>(spec.numChannels, (size_t) factor, oversamplerType, true, true);
+            oversampler->initProcessing(spec.maximumBlockSize);
+
+            latencies[(size_t) type][(size_t) factor] = juce::roundToInt(oversampler->getLatencyInSamples());
+        }
+    }
+
+    // Each half of a switch takes 5 ms, which is short enough not to be noticed as a dropout
+    switchGain.reset(sampleRate, 0.005);
+
+    currentFactor = targetFactor;
+    currentFilterType = targetFilterType;
+
+    reset();
+}
+
+template void OversamplingStage::prepare<float>(const juce::dsp::ProcessSpec&);
+template void OversamplingStage::prepare<double>(const juce::dsp::ProcessSpec&);
+
+void OversamplingStage::reset() noexcept
+{
+    auto resetAll = [](auto& table)
+    {
+        for (auto& oversamplersOfType : table)
+            for (auto& oversampler : oversamplersOfType)
+                if (oversampler != nullptr)
+                    oversampler->reset();
+    };
+
+    resetAll(floatOversamplers);
+    resetAll(doubleOversamplers);
+
+    switchGain.setCurrentAndTargetValue(1.f);
+}
+
+void OversamplingStage::setTarget(int factor, FilterType filterType) noexcept
+{
+    jassert(juce::isPositiveAndNotGreaterThan(factor, maxFactor));
+
+    targetFactor = juce::jlimit(0, maxFactor, factor);
+    targetFilterType = filterType;
+
+    // Heading back to the current setting mid-duck just fades back in
+    switchGain.setTargetValue(isSwitching() ? 0.f : 1.f);
+}
+
+int OversamplingStage::getLatencySamples(int factor, FilterType filterType) const noexcept
+{
+    return latencies[(size_t) filterType][(size_t) juce::jlimit(0, maxFactor, factor)];
+}
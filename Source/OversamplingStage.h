@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    OversamplingStage.h
+
+    Optional 2x/4x/8x oversampling around the band cascade. The bilinear
+    transform cramps bells placed near Nyquist; running the cascade at a
+    multiple of the host rate pushes that cramping well above the audio band.
+
+    Every factor and filter type is allocated up front in prepare(), so the
+    audio thread can switch between them. A switch ducks the output to
+    silence, changes oversampler while nothing is audible, then fades back
+    in, so neither the change of filter state nor the change of latency
+    clicks.
+
+    The stage runs at the precision it was last prepared for, float or
+    double, and only holds oversamplers for that one.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class OversamplingStage
+{
+public:
+    enum FilterType
+    {
+        polyphaseIIR,
+        linearPhaseFIR,
+        numFilterTypes
+    };
+
+    // Factors are powers of two: 0 is off, 1 is 2x, 2 is 4x and 3 is 8x
+    static constexpr int maxFactor = 3;
+    static constexpr int numFactors = maxFactor + 1;
+
+    OversamplingStage() = default;
+
+    // Allocates every oversampler for SampleType and frees the other precision's. The stage
+    // starts at whatever factor was last set.
+    template <typename SampleType>
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    void reset() noexcept;
+
+    // Safe to call from the audio thread. The change takes effect once the output has ducked.
+    void setTarget(int factor, FilterType filterType) noexcept;
+
+    int getFactor() const noexcept { return currentFactor; }
+
+    // The rate the cascade runs at for the current factor
+    double getProcessingRate() const noexcept { return sampleRate * (1 << currentFactor); }
+
+    // Latency at the host rate, for any factor. Valid after prepare().
+    int getLatencySamples(int factor, FilterType filterType) const noexcept;
+
+    // Runs processCascade over the block at the current oversampled rate. Returns true if the
+    // factor changed at the end of the block, in which case the cascade must be redesigned for
+    // getProcessingRate() before the next one.
+    template <typename SampleType, typename ProcessFunction>
+    bool process(juce::dsp::AudioBlock<SampleType>& block, ProcessFunction&& processCascade) noexcept
+    {
+        if (auto* oversampler = getOversampler<SampleType>(currentFactor, currentFilterType))
+        {
+            auto oversampledBlock = oversampler->processSamplesUp(block);
+            processCascade(oversampledBlock);
+            oversampler->processSamplesDown(block);
+        }
+        else
+        {
+            processCascade(block);
+        }
+
+        if (! isSwitching() && ! switchGain.isSmoothing())
+            return false;
+
+        block.multiplyBy(switchGain);
+
+        if (! isSwitching() || switchGain.isSmoothing())
+            return false;
+
+        // Fully ducked: swap oversamplers while nothing can be heard and fade back in
+        currentFactor = targetFactor;
+        currentFilterType = targetFilterType;
+
+        if (auto* oversampler = getOversampler<SampleType>(currentFactor, currentFilterType))
+            oversampler->reset();
+
+        switchGain.setTargetValue(1.f);
+        return true;
+    }
+
+private:
+    template <typename SampleType>
+    using Oversampler = juce::dsp::Oversampling<SampleType>;
+
+    template <typename SampleType>
+    using OversamplerTable = std::array<std::array<std::unique_ptr<Oversampler<SampleType>>, (size_t) maxFactor>, (size_t) numFilterTypes>;
+
+    bool isSwitching() const noexcept
+    {
+        return targetFactor != currentFactor || (currentFactor > 0 && targetFilterType != currentFilterType);
+    }
+
+    template <typename SampleType>
+    OversamplerTable<SampleType>& getOversamplers() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleOversamplers;
+        else
+            return floatOversamplers;
+    }
+
+    template <typename SampleType>
+    Oversampler<SampleType>* getOversampler(int factor, FilterType filterType) noexcept
+    {
+        return factor > 0 ? getOversamplers<SampleType>()[(size_t) filterType][(size_t) factor - 1].get() : nullptr;
+    }
+
+    OversamplerTable<float> floatOversamplers;
+    OversamplerTable<double> doubleOversamplers;
+    std::array<std::array<int, (size_t) numFactors>, (size_t) numFilterTypes> latencies{};
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> switchGain{ 1.f };
+
+    double sampleRate{ 44100.0 };
+    int currentFactor{ 0 }, targetFactor{ 0 };
+    FilterType currentFilterType{ polyphaseIIR }, targetFilterType{ polyphaseIIR };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OversamplingStage)
+};
@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+#include "BackgroundThread.h"
+
+//==============================================================================
+// Keeps track of every live monitor and, when asked to by the environment, writes a report of
+// all of them from the shared background thread. Never touched by the audio thread.
+class PerformanceMonitor::Registry  : private juce::TimeSliceClient
+{
+public:
+    Registry()
+        : logFile(getLogFileFromEnvironment())
+    {
+        if (logFile != juce::File())
+            backgroundThread->addTimeSliceClient(this);
+    }
+
+    ~Registry() override
+    {
+        backgroundThread->removeTimeSliceClient(this);
+    }
+
+    void add(PerformanceMonitor* monitor)
+    {
+        const juce::ScopedLock sl(lock);
+        monitors.add(monitor);
+    }
+
+    void remove(PerformanceMonitor* monitor)
+    {
+        const juce::ScopedLock sl(lock);
+        monitors.removeFirstMatchingValue(monitor);
+    }
+
+private:
+    static juce::File getLogFileFromEnvironment()
+    {
+        auto path = juce::SystemStats::getEnvironmentVariable("FEATHERING_PERFORMANCE_LOG", {});
+        return juce::File::isAbsolutePath(path) ? juce::File(path) : juce::File();
+    }
+
+    int useTimeSlice() override
+    {
+        constexpr int reportIntervalMs = 5000;
+
+        std::vector<Snapshot> snapshots;
+
+        {
+            const juce::ScopedLock sl(lock);
+
+            for (auto* monitor : monitors)
+                snapshots.push_back(monitor->getSnapshot());
+        }
+
+        // Worst first: overruns, then peak load
+        std::sort(snapshots.begin(), snapshots.end(), [](const Snapshot& a, const Snapshot& b)
+        {
+            return a.numOverruns != b.numOverruns ? a.numOverruns > b.numOverruns
+                                                  : a.peakLoad > b.peakLoad;
+        });
+
+        juce::String report;
+        report << "Feathering performance report, " << juce::Time::getCurrentTime().toString(true, true)
+               << ", " << (int) snapshots.size() << " instances" << juce::newLine << juce::newLine;
+
+        for (const auto& snapshot : snapshots)
+            report << snapshot.toString() << juce::newLine;
+
+        logFile.replaceWithText(report);
+        return reportIntervalMs;
+    }
+
+    juce::SharedResourcePointer<SharedBackgroundThread> backgroundThread;
+    const juce::File logFile;
+
+    juce::CriticalSection lock;
+    juce::Array<PerformanceMonitor*> monitors;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Registry)
+};
+
+//==============================================================================
+juce::String PerformanceMonitor::Snapshot::toString() const
+{
+    juce::String text;
+
+    text << (name.isNotEmpty() ? name : juce::String("(unnamed)")) << juce::newLine
+         << "  blocks " << numBlocks << ", overruns " << numOverruns
+         << ", load now " << juce::String(currentLoad * 100.f, 1) << "%"
+         << ", average " << juce::String(averageLoad * 100.f, 1) << "%"
+         << ", peak " << juce::String(peakLoad * 100.f, 1) << "%"
+         << ", worst block " << juce::String(worstBlockMicroseconds, 1) << " us" << juce::newLine
+         << "  coefficient updates " << numCoefficientUpdates << ", kernel builds " << numKernelBuilds
+         << ", denormal samples " << numDenormalSamples << ", non-finite blocks " << numNonFiniteBlocks
+         << ", audio-thread allocations " << numAudioThreadAllocations << juce::newLine
+         << "  load histogram (" << juce::roundToInt(histogramBinWidth * 100.f) << "% bins):";
+
+    for (auto count : histogram)
+        text << ' ' << (int) count;
+
+    return text << juce::newLine;
+}
+
+//==============================================================================
+PerformanceMonitor::PerformanceMonitor()
+{
+    registry->add(this);
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+    registry->remove(this);
+}
+
+void PerformanceMonitor::prepare(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    resetStatistics();
+}
+
+PerformanceMonitor::ScopedBlock::ScopedBlock(PerformanceMonitor& monitorToUse, int numSamplesInBlock) noexcept
+    : monitor(monitorToUse),
+      startTicks(juce::Time::getHighResolutionTicks()),
+      startAllocations(AllocationTripwire::getNumRealtimeAllocationsOnThisThread()),
+      numSamples(numSamplesInBlock)
+{
+    if (monitor.resetRequested.exchange(false))
+        monitor.clearStatistics();
+}
+
+PerformanceMonitor::ScopedBlock::~ScopedBlock() noexcept
+{
+    monitor.recordBlock(juce::Time::getHighResolutionTicks() - startTicks, numSamples,
+                        AllocationTripwire::getNumRealtimeAllocationsOnThisThread() - startAllocations);
+}
+
+void PerformanceMonitor::recordBlock(juce::int64 elapsedTicks, int numSamples, juce::int64 numAllocations) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    auto blockSeconds = numSamples / sampleRate;
+    auto load = (float) (elapsedTicks / ticksPerSecond / blockSeconds);
+
+    increment(numBlocks);
+
+    if (load > 1.f)
+        increment(numOverruns);
+
+    if (numAllocations > 0)
+        increment(numAudioThreadAllocations, numAllocations);
+
+    auto bin = juce::jmin(numHistogramBins - 1, (int) (load / histogramBinWidth));
+    auto& binCount = histogram[(size_t) bin];
+    binCount.store(binCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    // Average over roughly the last second of audio, whatever the block size
+    auto smoothing = (float) juce::jmin(1.0, blockSeconds);
+    auto average = averageLoad.load(std::memory_order_relaxed);
+
+    currentLoad.store(load, std::memory_order_relaxed);
+    averageLoad.store(average + smoothing * (load - average), std::memory_order_relaxed);
+
+    if (load > peakLoad.load(std::memory_order_relaxed))
+        peakLoad.store(load, std::memory_order_relaxed);
+
+    if (elapsedTicks > worstBlockTicks.load(std::memory_order_relaxed))
+        worstBlockTicks.store(elapsedTicks, std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+bool PerformanceMonitor::checkOutput(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    constexpr auto isDouble = std::is_same_v<SampleType, double>;
+
+    using Bits = std::conditional_t<isDouble, juce::uint64, juce::uint32>;
+    constexpr Bits exponentMask = isDouble ? (Bits) 0x7ff0000000000000ull : (Bits) 0x7f800000;
+    constexpr Bits mantissaMask = isDouble ? (Bits) 0x000fffffffffffffull : (Bits) 0x007fffff;
+
+    int numDenormals = 0, numNonFinite = 0;
+
+    // Classify on the bit patterns, which vectorises and isn't affected by flush-to-zero
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
+        {
+            Bits bits;
+            std::memcpy(&bits, samples + i, sizeof(bits));
+
+            auto exponent = bits & exponentMask;
+            numNonFinite += exponent == exponentMask ? 1 : 0;
+            numDenormals += (exponent == 0 && (bits & mantissaMask) != 0) ? 1 : 0;
+        }
+    }
+
+    if (numDenormals > 0)
+        increment(numDenormalSamples, numDenormals);
+
+    if (numNonFinite > 0)
+        increment(numNonFiniteBlocks);
+
+    return numNonFinite == 0;
+}
+
+template bool PerformanceMonitor::checkOutput<float>(const juce::dsp::AudioBlock<float>&) noexcept;
+template bool PerformanceMonitor::checkOutput<double>(const juce::dsp::AudioBlock<double>&) noexcept;
+
+void PerformanceMonitor::clearStatistics() noexcept
+{
+    for (auto* counter : { &numBlocks, &numOverruns, &numDenormalSamples, &numNonFiniteBlocks,
+                           &numAudioThreadAllocations, &worstBlockTicks })
+        counter->store(0, std::memory_order_relaxed);
+
+    for (auto* value : { &currentLoad, &averageLoad, &peakLoad })
+        value->store(0.f, std::memory_order_relaxed);
+
+    for (auto& binCount : histogram)
+        binCount.store(0, std::memory_order_relaxed);
+}
+
+PerformanceMonitor::Snapshot PerformanceMonitor::getSnapshot() const
+{
+    Snapshot snapshot;
+
+    {
+        const juce::ScopedLock sl(nameLock);
+        snapshot.name = name;
+    }
+
+    snapshot.numBlocks = numBlocks.load();
+    snapshot.numOverruns = numOverruns.load();
+    snapshot.numCoefficientUpdates = numCoefficientUpdates.load();
+    snapshot.numKernelBuilds = numKernelBuilds.load();
+    snapshot.numDenormalSamples = numDenormalSamples.load();
+    snapshot.numNonFiniteBlocks = numNonFiniteBlocks.load();
+    snapshot.numAudioThreadAllocations = numAudioThreadAllocations.load();
+    snapshot.currentLoad = currentLoad.load();
+    snapshot.averageLoad = averageLoad.load();
+    snapshot.peakLoad = peakLoad.load();
+    snapshot.worstBlockMicroseconds = (double) worstBlockTicks.load() / ticksPerSecond * 1.0e6;
+
+    for (size_t bin = 0; bin < histogram.size(); ++bin)
+        snapshot.histogram[bin] = histogram[bin].load();
+
+    return snapshot;
+}
+
+void PerformanceMonitor::setName(const juce::String& newName)
+{
+    const juce::ScopedLock sl(nameLock);
+    name = newName;
+}
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+
+    Per-instance audio-thread instrumentation: block timing as a load
+    histogram, load relative to the block's real-time duration, overruns,
+    coefficient recomputes, linear-phase kernel builds, denormal and
+    NaN/Inf output, and allocations caught by the AllocationTripwire.
+
+    The audio thread is the only writer. Every counter is an atomic it
+    updates with plain loads and stores, so recording a block never waits
+    on anything. Any other thread can take a Snapshot at any time; a
+    snapshot is not an atomic view of all the counters together, which is
+    fine for monitoring.
+
+    Every monitor registers with a process-wide registry. If the
+    FEATHERING_PERFORMANCE_LOG environment variable names a file, the
+    registry rewrites it every few seconds with a report of all instances,
+    worst first, so the ones blowing deadlines in a big session stand out.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AllocationTripwire.h"
+
+class PerformanceMonitor
+{
+public:
+    // Block load in 5% steps up to 200%; the last bin collects everything above that
+    static constexpr int numHistogramBins = 41;
+    static constexpr float histogramBinWidth = 0.05f;
+
+    struct Snapshot
+    {
+        juce::String name;
+
+        juce::int64 numBlocks{ 0 }, numOverruns{ 0 };
+        juce::int64 numCoefficientUpdates{ 0 }, numKernelBuilds{ 0 };
+        juce::int64 numDenormalSamples{ 0 }, numNonFiniteBlocks{ 0 };
+        juce::int64 numAudioThreadAllocations{ 0 };
+
+        float currentLoad{ 0.f }, averageLoad{ 0.f }, peakLoad{ 0.f };
+        double worstBlockMicroseconds{ 0.0 };
+
+        std::array<juce::uint32, (size_t) numHistogramBins> histogram{};
+
+        juce::String toString() const;
+    };
+
+    PerformanceMonitor();
+    ~PerformanceMonitor();
+
+    void prepare(double sampleRate) noexcept;
+
+    //==============================================================================
+    // Audio thread
+
+    // Times one processBlock call and marks it as a real-time section for the allocation tripwire.
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock(PerformanceMonitor& monitorToUse, int numSamples) noexcept;
+        ~ScopedBlock() noexcept;
+
+    private:
+        PerformanceMonitor& monitor;
+        AllocationTripwire::ScopedRealtimeSection realtimeSection;
+        juce::int64 startTicks, startAllocations;
+        int numSamples;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    // Running totals kept by the engines, copied in once per block
+    void setNumCoefficientUpdates(juce::int64 total) noexcept  { numCoefficientUpdates.store(total, std::memory_order_relaxed); }
+    void setNumKernelBuilds(juce::int64 total) noexcept        { numKernelBuilds.store(total, std::memory_order_relaxed); }
+
+    // Counts denormal samples in the output and returns false if any sample is NaN or infinite.
+    template <typename SampleType>
+    bool checkOutput(const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    //==============================================================================
+    // Any other thread
+
+    Snapshot getSnapshot() const;
+
+    // Clears the statistics. The audio thread does the clearing at the start of its next block.
+    void resetStatistics() noexcept  { resetRequested.store(true); }
+
+    // A label for reports, such as the host's track name
+    void setName(const juce::String& newName);
+
+private:
+    static void increment(std::atomic<juce::int64>& counter, juce::int64 amount = 1) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void recordBlock(juce::int64 elapsedTicks, int numSamples, juce::int64 numAllocations) noexcept;
+    void clearStatistics() noexcept;
+
+    class Registry;
+    juce::SharedResourcePointer<Registry> registry;
+
+    std::atomic<juce::int64> numBlocks{ 0 }, numOverruns{ 0 };
+    std::atomic<juce::int64> numCoefficientUpdates{ 0 }, numKernelBuilds{ 0 };
+    std::atomic<juce::int64> numDenormalSamples{ 0 }, numNonFiniteBlocks{ 0 };
+    std::atomic<juce::int64> numAudioThreadAllocations{ 0 };
+    std::atomic<float> currentLoad{ 0.f }, averageLoad{ 0.f }, peakLoad{ 0.f };
+    std::atomic<juce::int64> worstBlockTicks{ 0 };
+    std::array<std::atomic<juce::uint32>, (size_t) numHistogramBins> histogram{};
+    std::atomic<bool> resetRequested{ false };
+
+    double sampleRate{ 44100.0 };
+    double ticksPerSecond{ (double) juce::Time::getHighResolutionTicksPerSecond() };
+
+    juce::CriticalSection nameLock;
+    juce::String name;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerformanceMonitor)
+};
@@ -9,13 +9,168 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+FeatheringIdeaStartAudioProcessorEditor::BandControls::BandControls(APVTS& apvts, int band)
+    : freqAttachment(apvts, FeatherParameters::getFreqID(band), freq),
+      gainAttachment(apvts, FeatherParameters::getGainID(band), gain),
+      qualityAttachment(apvts, FeatherParameters::getQualityID(band), quality),
+      thresholdAttachment(apvts, FeatherParameters::getThresholdID(band), threshold),
+      ratioAttachment(apvts, FeatherParameters::getRatioID(band), ratio)
+{
+    title.setText("Band " + juce::String(band + 1), juce::dontSendNotification);
+    title.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(title);
+
+    for (auto* slider : { &freq, &gain, &quality, &threshold, &ratio })
+    {
+        slider->setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+        slider->setTextBoxStyle(juce::Slider::TextBoxBelow, false, bandColumnWidth - 8, 18);
+        addAndMakeVisible(*slider);
+    }
+
+    // As with ChoiceControl, the items go in before the attachment
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(FeatherParameters::getPlacementID(band))))
+        placement.addItemList(choice->choices, 1);
+
+    addAndMakeVisible(placement);
+    placementAttachment = std::make_unique<APVTS::ComboBoxAttachment>(apvts, FeatherParameters::getPlacementID(band), placement);
+}
+
+void FeatheringIdeaStartAudioProcessorEditor::BandControls::resized()
+{
+    auto bounds = getLocalBounds().reduced(4);
+
+    title.setBounds(bounds.removeFromTop(20));
+    placement.setBounds(bounds.removeFromBottom(24).reduced(0, 2));
+
+    auto knobHeight = bounds.getHeight() / 5;
+
+    freq.setBounds(bounds.removeFromTop(knobHeight));
+    gain.setBounds(bounds.removeFromTop(knobHeight));
+    quality.setBounds(bounds.removeFromTop(knobHeight));
+    threshold.setBounds(bounds.removeFromTop(knobHeight));
+    ratio.setBounds(bounds);
+}
+
+//==============================================================================
+FeatheringIdeaStartAudioProcessorEditor::ChoiceControl::ChoiceControl(APVTS& apvts, const juce::String& parameterID)
+{
+    label.setText(parameterID, juce::dontSendNotification);
+    label.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(label);
+
+    // The attachment selects by item index, so the items have to be there first
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(parameterID)))
+        comboBox.addItemList(choice->choices, 1);
+
+    addAndMakeVisible(comboBox);
+    attachment = std::make_unique<APVTS::ComboBoxAttachment>(apvts, parameterID, comboBox);
+}
+
+void FeatheringIdeaStartAudioProcessorEditor::ChoiceControl::resized()
+{
+    auto bounds = getLocalBounds();
+
+    label.setBounds(bounds.removeFromLeft(bounds.getWidth() / 2));
+    comboBox.setBounds(bounds.reduced(2));
+}
+
+//==============================================================================
+FeatheringIdeaStartAudioProcessorEditor::SliderControl::SliderControl(APVTS& apvts, const juce::String& parameterID)
+    : attachment(apvts, parameterID, slider)
+{
+    label.setText(parameterID, juce::dontSendNotification);
+    label.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(label);
+
+    slider.setSliderStyle(juce::Slider::LinearHorizontal);
+    slider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 64, 18);
+    addAndMakeVisible(slider);
+}
+
+void FeatheringIdeaStartAudioProcessorEditor::SliderControl::resized()
+{
+    auto bounds = getLocalBounds();
+
+    label.setBounds(bounds.removeFromLeft(60));
+    slider.setBounds(bounds.reduced(2));
+}
+
+//==============================================================================
+FeatheringIdeaStartAudioProcessorEditor::SnapshotControls::SnapshotControls(FeatheringIdeaStartAudioProcessor& processor)
+    : morphAttachment(processor.apvts, FeatherParameters::morphID, morph)
+{
+    for (int snapshot = 0; snapshot < FeatheringIdeaStartAudioProcessor::numSnapshots; ++snapshot)
+    {
+        auto name = SnapshotBank<FeatheringIdeaStartAudioProcessor::numBands>::getSnapshotName(snapshot);
+
+        auto* store = storeButtons.add(new juce::TextButton("Store " + name));
+        store->onClick = [&processor, snapshot] { processor.storeSnapshot(snapshot); };
+        addAndMakeVisible(store);
+
+        auto* recall = recallButtons.add(new juce::TextButton(name));
+        recall->onClick = [&processor, snapshot] { processor.recallSnapshot(snapshot); };
+        addAndMakeVisible(recall);
+    }
+
+    morphLabel.setText(FeatherParameters::morphID, juce::dontSendNotification);
+    morphLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(morphLabel);
+
+    morph.setSliderStyle(juce::Slider::LinearHorizontal);
+    morph.setTextBoxStyle(juce::Slider::TextBoxRight, false, 48, 18);
+    addAndMakeVisible(morph);
+}
+
+void FeatheringIdeaStartAudioProcessorEditor::SnapshotControls::resized()
+{
+    auto bounds = getLocalBounds();
+
+    for (int snapshot = 0; snapshot < storeButtons.size(); ++snapshot)
+    {
+        storeButtons[snapshot]->setBounds(bounds.removeFromLeft(70).reduced(2));
+        recallButtons[snapshot]->setBounds(bounds.removeFromLeft(32).reduced(2));
+        bounds.removeFromLeft(6);
+    }
+
+    morphLabel.setBounds(bounds.removeFromLeft(60));
+    morph.setBounds(bounds.reduced(2));
+}
+
 //==============================================================================
 FeatheringIdeaStartAudioProcessorEditor::FeatheringIdeaStartAudioProcessorEditor (FeatheringIdeaStartAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p),
+      analyzer (p.getAnalyzer(), p.getPerformanceMonitor(), p.getResponseCurve()),
+      snapshotControls (p)
 {
+    addAndMakeVisible(analyzer);
+
+    for (auto* parameterID : { FeatherParameters::phaseModeID, FeatherParameters::kernelLengthID,
+                               FeatherParameters::oversamplingID, FeatherParameters::oversamplingFilterID,
+                               FeatherParameters::snapshotMorphID, FeatherParameters::channelModeID,
+                               FeatherParameters::lowCutSlopeID, FeatherParameters::highCutSlopeID })
+        addAndMakeVisible(choiceControls.add(new ChoiceControl(audioProcessor.apvts, parameterID)));
+
+    addAndMakeVisible(snapshotControls);
+
+    // Attack and release for the dynamic bands, then the cut frequencies
+    for (auto* parameterID : { FeatherParameters::attackID, FeatherParameters::releaseID,
+                               FeatherParameters::lowCutFreqID, FeatherParameters::highCutFreqID })
+        addAndMakeVisible(sliderControls.add(new SliderControl(audioProcessor.apvts, parameterID)));
+
+    for (int band = 0; band < FeatheringIdeaStartAudioProcessor::numBands; ++band)
+        bandStrip.addAndMakeVisible(bandControls.add(new BandControls(audioProcessor.apvts, band)));
+
+    // Large banks scroll sideways rather than squashing the knobs
+    bandViewport.setViewedComponent(&bandStrip, false);
+    bandViewport.setScrollBarsShown(false, true);
+    addAndMakeVisible(bandViewport);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setResizable(true, true);
+    setResizeLimits(600, 600, 2000, 1200);
+    setSize (900, 760);
 }
 
 FeatheringIdeaStartAudioProcessorEditor::~FeatheringIdeaStartAudioProcessorEditor()
@@ -27,14 +182,33 @@ void FeatheringIdeaStartAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void FeatheringIdeaStartAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    auto bounds = getLocalBounds();
+
+    analyzer.setBounds(bounds.removeFromTop(juce::roundToInt(bounds.getHeight() * 0.5f)));
+
+    auto choiceRow = bounds.removeFromTop(32).reduced(4);
+    auto choiceWidth = choiceRow.getWidth() / juce::jmax(1, choiceControls.size());
+
+    for (auto* control : choiceControls)
+        control->setBounds(choiceRow.removeFromLeft(choiceWidth));
+
+    snapshotControls.setBounds(bounds.removeFromTop(32).reduced(4));
+
+    auto sliderRow = bounds.removeFromTop(32).reduced(4);
+    auto sliderWidth = sliderRow.getWidth() / juce::jmax(1, sliderControls.size());
+
+    for (auto* control : sliderControls)
+        control->setBounds(sliderRow.removeFromLeft(sliderWidth));
+
+    bandViewport.setBounds(bounds);
+
+    auto stripHeight = bounds.getHeight() - bandViewport.getScrollBarThickness();
+    bandStrip.setSize(juce::jmax(bounds.getWidth(), bandColumnWidth * bandControls.size()), stripHeight);
+
+    for (int band = 0; band < bandControls.size(); ++band)
+        bandControls[band]->setBounds(band * bandColumnWidth, 0, bandColumnWidth, stripHeight);
 }
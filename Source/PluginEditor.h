@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "AnalyzerComponent.h"
 
 //==============================================================================
 /**
@@ -25,9 +26,74 @@ public:
     void resized() override;
 
 private:
+    using APVTS = juce::AudioProcessorValueTreeState;
+
+    // Frequency, gain, Q, threshold and ratio knobs for one band, and which channels it's on
+    struct BandControls  : public juce::Component
+    {
+        BandControls(APVTS& apvts, int band);
+
+        void resized() override;
+
+        juce::Label title;
+        juce::Slider freq, gain, quality, threshold, ratio;
+        APVTS::SliderAttachment freqAttachment, gainAttachment, qualityAttachment, thresholdAttachment, ratioAttachment;
+        juce::ComboBox placement;
+        std::unique_ptr<APVTS::ComboBoxAttachment> placementAttachment;
+    };
+
+    // A labelled combo box for one of the global choice parameters
+    struct ChoiceControl  : public juce::Component
+    {
+        ChoiceControl(APVTS& apvts, const juce::String& parameterID);
+
+        void resized() override;
+
+        juce::Label label;
+        juce::ComboBox comboBox;
+        std::unique_ptr<APVTS::ComboBoxAttachment> attachment;
+    };
+
+    // A labelled horizontal slider for one of the global float parameters
+    struct SliderControl  : public juce::Component
+    {
+        SliderControl(APVTS& apvts, const juce::String& parameterID);
+
+        void resized() override;
+
+        juce::Label label;
+        juce::Slider slider;
+        APVTS::SliderAttachment attachment;
+    };
+
+    // Store and recall buttons for each snapshot, and the morph between them
+    struct SnapshotControls  : public juce::Component
+    {
+        SnapshotControls(FeatheringIdeaStartAudioProcessor& processor);
+
+        void resized() override;
+
+        juce::OwnedArray<juce::TextButton> storeButtons, recallButtons;
+        juce::Label morphLabel;
+        juce::Slider morph;
+        APVTS::SliderAttachment morphAttachment;
+    };
+
+    static constexpr int bandColumnWidth = 96;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     FeatheringIdeaStartAudioProcessor& audioProcessor;
 
+    AnalyzerComponent analyzer;
+
+    juce::OwnedArray<ChoiceControl> choiceControls;
+    juce::OwnedArray<SliderControl> sliderControls;
+    SnapshotControls snapshotControls;
+
+    juce::Component bandStrip;
+    juce::Viewport bandViewport;
+    juce::OwnedArray<BandControls> bandControls;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeatheringIdeaStartAudioProcessorEditor)
 };
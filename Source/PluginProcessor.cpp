@@ -9,6 +9,15 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+namespace
+{
+    void setParameterValue(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = apvts.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+}
+
 //==============================================================================
 FeatheringIdeaStartAudioProcessor::FeatheringIdeaStartAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -22,10 +31,40 @@ FeatheringIdeaStartAudioProcessor::FeatheringIdeaStartAudioProcessor()
                        )
 #endif
 {
+    phaseModeParam = apvts.getRawParameterValue(FeatherParameters::phaseModeID);
+    kernelLengthParam = apvts.getRawParameterValue(FeatherParameters::kernelLengthID);
+    oversamplingParam = apvts.getRawParameterValue(FeatherParameters::oversamplingID);
+    oversamplingFilterParam = apvts.getRawParameterValue(FeatherParameters::oversamplingFilterID);
+    snapshotMorphParam = apvts.getRawParameterValue(FeatherParameters::snapshotMorphID);
+    morphParam = apvts.getRawParameterValue(FeatherParameters::morphID);
+    attackParam = apvts.getRawParameterValue(FeatherParameters::attackID);
+    releaseParam = apvts.getRawParameterValue(FeatherParameters::releaseID);
+    channelModeParam = apvts.getRawParameterValue(FeatherParameters::channelModeID);
+
+    cutFreqParams = { apvts.getRawParameterValue(FeatherParameters::lowCutFreqID), apvts.getRawParameterValue(FeatherParameters::highCutFreqID) };
+    cutSlopeParams = { apvts.getRawParameterValue(FeatherParameters::lowCutSlopeID), apvts.getRawParameterValue(FeatherParameters::highCutSlopeID) };
+
+    apvts.addParameterListener(FeatherParameters::phaseModeID, this);
+    apvts.addParameterListener(FeatherParameters::kernelLengthID, this);
+    apvts.addParameterListener(FeatherParameters::oversamplingID, this);
+    apvts.addParameterListener(FeatherParameters::oversamplingFilterID, this);
+    startTimerHz(10);
+
+    // Until the host names our track, number the instances so reports can tell them apart
+    static std::atomic<int> instanceCount{ 0 };
+    performanceMonitor.setName(getName() + " #" + juce::String(++instanceCount));
+
+    snapshotBank.addToState(stateSerializer);
 }
 
 FeatheringIdeaStartAudioProcessor::~FeatheringIdeaStartAudioProcessor()
 {
+    apvts.removeParameterListener(FeatherParameters::phaseModeID, this);
+    apvts.removeParameterListener(FeatherParameters::kernelLengthID, this);
+    apvts.removeParameterListener(FeatherParameters::oversamplingID, this);
+    apvts.removeParameterListener(FeatherParameters::oversamplingFilterID, this);
+
+    stopTimer();
 }
 
 //==============================================================================
@@ -63,7 +102,7 @@ bool FeatheringIdeaStartAudioProcessor::isMidiEffect() const
 
 double FeatheringIdeaStartAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return reportedTailSeconds.load();
 }
 
 int FeatheringIdeaStartAudioProcessor::getNumPrograms()
@@ -99,40 +138,58 @@ void FeatheringIdeaStartAudioProcessor::prepareToPlay (double sampleRate, int sa
 
     spec.maximumBlockSize = samplesPerBlock;
 
-    spec.numChannels = 1;
+    spec.numChannels = (juce::uint32) getTotalNumOutputChannels();
 
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    if (isUsingDoublePrecision())
+        prepareMinimumPhase<double>(spec);
+    else
+        prepareMinimumPhase<float>(spec);
 
-    auto chainSettings = getChainSettings(apvts);
+    linearPhaseEngine.setKernelLength(getKernelLength());
+    linearPhaseEngine.prepare(spec);
 
-    auto peak1Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peak1Freq, chainSettings.peak1Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak1GainInDecibels));
+    wasLinearPhase = isLinearPhase();
+    silenceGate.reset();
+    updateLatency();
 
-    auto peak2Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peak2Freq, chainSettings.peak2Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak2GainInDecibels));
+    // Hosts mostly read the tail when they activate the plugin, so have the worst case so far ready
+    growReportedTail(juce::jmax(tailSeconds.load(), isLinearPhase() ? (double) getKernelLength() / sampleRate : 0.0));
 
-    auto peak3Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peak3Freq, chainSettings.peak3Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak3GainInDecibels));
+    performanceMonitor.prepare(sampleRate);
+    analyzer.prepare(sampleRate, getTotalNumInputChannels());
+}
 
-    auto peak4Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peak4Freq, chainSettings.peak4Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak4GainInDecibels));
-    
+template <typename SampleType>
+void FeatheringIdeaStartAudioProcessor::prepareMinimumPhase(const juce::dsp::ProcessSpec& spec)
+{
+    auto& engine = getFeatherEngine<SampleType>();
 
-    
+    coefficientUpdater.markAllBandsDirty();
+    snapshotBank.invalidateMorph();
+    updateBandTargets<SampleType>();
 
-    *leftChain.get<ChainPositions::Peak1>().coefficients = *peak1Coefficients;
-    *leftChain.get<ChainPositions::Peak2>().coefficients = *peak2Coefficients;
-    *leftChain.get<ChainPositions::Peak3>().coefficients = *peak3Coefficients;
-    *leftChain.get<ChainPositions::Peak4>().coefficients = *peak4Coefficients;
+    currentCuts = getCutSettings();
 
-    *rightChain.get<ChainPositions::Peak1>().coefficients = *peak1Coefficients;
-    *rightChain.get<ChainPositions::Peak2>().coefficients = *peak2Coefficients;
-    *rightChain.get<ChainPositions::Peak3>().coefficients = *peak3Coefficients;
-    *rightChain.get<ChainPositions::Peak4>().coefficients = *peak4Coefficients;
-    
+    for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+    {
+        engine.setCutTarget(cut, currentCuts[(size_t) cut]);
+        responseCurve.setCutTarget(cut, currentCuts[(size_t) cut]);
+    }
+
+    // Every oversampling factor is allocated here; the cascade is designed for the current one
+    oversampling.setTarget(getOversamplingFactor(), getOversamplingFilterType());
+    oversampling.prepare<SampleType>(spec);
+
+    auto cascadeSpec = spec;
+    cascadeSpec.sampleRate = oversampling.getProcessingRate();
+    cascadeSpec.maximumBlockSize = spec.maximumBlockSize << OversamplingStage::maxFactor;
+
+    // prepare() snaps every band to the targets just set, so playback starts without a ramp
+    engine.setChannelRoles(ChannelRoles::fromChannelSet(getChannelLayoutOfBus(false, 0)));
+    engine.setChannelMode(juce::roundToInt(channelModeParam->load()));
+    engine.prepare(cascadeSpec);
 }
 
 void FeatheringIdeaStartAudioProcessor::releaseResources()
@@ -148,12 +205,11 @@ bool FeatheringIdeaStartAudioProcessor::isBusesLayoutSupported (const BusesLayou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout the engine has lanes for: mono, stereo, surround, immersive or discrete.
+    // ChannelRoles works out which channels are which once the layout is settled.
+    const auto& output = layouts.getMainOutputChannelSet();
+
+    if (output.isDisabled() || output.size() > ChannelRoles::maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -169,7 +225,38 @@ bool FeatheringIdeaStartAudioProcessor::isBusesLayoutSupported (const BusesLayou
 
 void FeatheringIdeaStartAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    processSamples(buffer);
+}
+
+void FeatheringIdeaStartAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+void FeatheringIdeaStartAudioProcessor::reset()
+{
+    featherEngine.reset();
+    doubleFeatherEngine.reset();
+    oversampling.reset();
+    linearPhaseEngine.reset();
+    silenceGate.reset();
+}
+
+bool FeatheringIdeaStartAudioProcessor::isWaitingForKernel() const noexcept
+{
+    return isLinearPhase() && ! linearPhaseEngine.isKernelInstalled();
+}
+
+template <typename SampleType>
+void FeatheringIdeaStartAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
+{
+    jassert((std::is_same_v<SampleType, double>) == isUsingDoublePrecision());
+
+    auto& engine = getFeatherEngine<SampleType>();
+
     juce::ScopedNoDenormals noDenormals;
+    PerformanceMonitor::ScopedBlock monitorBlock(performanceMonitor, buffer.getNumSamples());
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -182,157 +269,358 @@ void FeatheringIdeaStartAudioProcessor::processBlock (juce::AudioBuffer<float>&
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    auto chainSettings = getChainSettings(apvts);
+    auto numChangedBands = updateBandTargets<SampleType>();
+    auto cutsChanged = updateCutTargets<SampleType>();
+
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    auto inputBlock = block.getSubsetChannelBlock(0, (size_t) totalNumInputChannels);
+
+    analyzer.push(SpectrumAnalyzer::pre, inputBlock);
+
+    auto linearPhase = isLinearPhase();
+
+    // Whichever engine we switch to has stale state from the last time it ran
+    if (linearPhase != wasLinearPhase)
+    {
+        if (linearPhase)
+        {
+            linearPhaseEngine.reset();
+            linearPhaseEngine.requestKernelUpdate();
+        }
+        else
+        {
+            engine.reset();
+            oversampling.reset();
+        }
+
+        wasLinearPhase = linearPhase;
+    }
+
+    if (linearPhase)
+    {
+        linearPhaseEngine.setKernelLength(getKernelLength());
+
+        if (numChangedBands > 0 || cutsChanged)
+            linearPhaseEngine.requestKernelUpdate();
+    }
+    else
+    {
+        oversampling.setTarget(getOversamplingFactor(), getOversamplingFilterType());
+        engine.setDynamicsTimes(attackParam->load(), releaseParam->load());
+        engine.setChannelMode(juce::roundToInt(channelModeParam->load()));
+    }
+
+    updateTail(linearPhase ? (double) getKernelLength() / getSampleRate()
+                           : engine.getTailSeconds() + oversampling.getLatencySamples(getOversamplingFactor(), getOversamplingFilterType()) / getSampleRate());
+
+    // Once the input has been silent for longer than the tail there's nothing left to hear, so
+    // the filters sleep until it comes back, and then start again from rest
+    auto wasIdle = silenceGate.isIdle();
+
+    if (silenceGate.update(SilenceGate::isSilent(inputBlock), (int) inputBlock.getNumSamples()))
+    {
+        inputBlock.clear();
+        analyzer.push(SpectrumAnalyzer::post, inputBlock);
+        return;
+    }
+
+    if (wasIdle)
+    {
+        engine.reset();
+        oversampling.reset();
+        linearPhaseEngine.reset();
+    }
+
+    if (linearPhase)
+    {
+        linearPhaseEngine.process(juce::dsp::ProcessContextReplacing<SampleType>(inputBlock));
+        responseCurve.setDesignRate(ResponseCurveBase::analoguePrototype);
+    }
+    else
+    {
+        // The linear-phase kernel comes from the analogue prototype, so only this path cramps and needs oversampling.
+        // Dynamic bands also only move here; the kernel holds them at their set gain.
+        auto factorChanged = oversampling.process(inputBlock, [&engine](juce::dsp::AudioBlock<SampleType>& cascadeBlock)
+        {
+            engine.process(juce::dsp::ProcessContextReplacing<SampleType>(cascadeBlock));
+        });
+
+        if (factorChanged)
+            engine.setSampleRate(oversampling.getProcessingRate());
+
+        responseCurve.setDesignRate(oversampling.getProcessingRate());
+    }
+
+    performanceMonitor.setNumCoefficientUpdates(engine.getNumCoefficientUpdates());
+    performanceMonitor.setNumKernelBuilds(linearPhaseEngine.getNumKernelBuilds());
+
+    // A NaN or Inf in the output means a filter has blown up: silence the block and start afresh
+    if (! performanceMonitor.checkOutput(inputBlock))
+    {
+        inputBlock.clear();
+        engine.reset();
+        oversampling.reset();
+        linearPhaseEngine.reset();
+    }
+
+    analyzer.push(SpectrumAnalyzer::post, inputBlock);
+}
 
-    auto peak1Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peak1Freq, chainSettings.peak1Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak1GainInDecibels));
+//==============================================================================
+bool FeatheringIdeaStartAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
 
-    auto peak2Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peak2Freq, chainSettings.peak2Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak2GainInDecibels));
+juce::AudioProcessorEditor* FeatheringIdeaStartAudioProcessor::createEditor()
+{
+    return new FeatheringIdeaStartAudioProcessorEditor (*this);
+}
 
-    auto peak3Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peak3Freq, chainSettings.peak3Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak3GainInDecibels));
+//==============================================================================
+void FeatheringIdeaStartAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    stateSerializer.write(destData);
+}
 
-    auto peak4Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peak4Freq, chainSettings.peak4Quality,
-        juce::Decibels::decibelsToGain(chainSettings.peak4GainInDecibels));
+void FeatheringIdeaStartAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    // The audio thread keeps its current bands until the whole state is in, then takes them all at once.
+    // A damaged, foreign or empty blob is rejected, which leaves the current settings as they were.
+    coefficientUpdater.beginRestore();
+    stateSerializer.read(data, sizeInBytes);
+    coefficientUpdater.endRestore();
 
+    snapshotBank.publish();
+}
 
+void FeatheringIdeaStartAudioProcessor::storeSnapshot(int snapshot)
+{
+    snapshotBank.store(snapshot, getChainSettings<numBands>(apvts));
+    snapshotBank.publish();
+}
 
+void FeatheringIdeaStartAudioProcessor::recallSnapshot(int snapshot)
+{
+    if (isMorphing())
+    {
+        setParameterValue(apvts, FeatherParameters::morphID, (float) snapshot);
+        return;
+    }
+
+    auto settings = snapshotBank.get(snapshot);
+
+    // The audio thread takes the recalled bands as one update, and crossfades to them if they're far off
+    coefficientUpdater.beginRestore();
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto& bandSettings = settings.bands[(size_t) band];
+
+        setParameterValue(apvts, FeatherParameters::getFreqID(band), bandSettings.freq);
+        setParameterValue(apvts, FeatherParameters::getGainID(band), bandSettings.gainInDecibels);
+        setParameterValue(apvts, FeatherParameters::getQualityID(band), bandSettings.quality);
+        setParameterValue(apvts, FeatherParameters::getThresholdID(band), bandSettings.thresholdInDecibels);
+        setParameterValue(apvts, FeatherParameters::getRatioID(band), bandSettings.ratio);
+        setParameterValue(apvts, FeatherParameters::getPlacementID(band), (float) bandSettings.placement);
+    }
+
+    coefficientUpdater.endRestore();
+}
 
-    *leftChain.get<ChainPositions::Peak1>().coefficients = *peak1Coefficients;
-    *leftChain.get<ChainPositions::Peak2>().coefficients = *peak2Coefficients;
-    *leftChain.get<ChainPositions::Peak3>().coefficients = *peak3Coefficients;
-    *leftChain.get<ChainPositions::Peak4>().coefficients = *peak4Coefficients;
+void FeatheringIdeaStartAudioProcessor::updateTrackProperties (const TrackProperties& properties)
+{
+    if (properties.name.isNotEmpty())
+        performanceMonitor.setName(properties.name);
+}
 
-    *rightChain.get<ChainPositions::Peak1>().coefficients = *peak1Coefficients;
-    *rightChain.get<ChainPositions::Peak2>().coefficients = *peak2Coefficients;
-    *rightChain.get<ChainPositions::Peak3>().coefficients = *peak3Coefficients;
-    *rightChain.get<ChainPositions::Peak4>().coefficients = *peak4Coefficients;
+bool FeatheringIdeaStartAudioProcessor::isLinearPhase() const noexcept
+{
+    return juce::roundToInt(phaseModeParam->load()) == FeatherParameters::linearPhase;
+}
 
+int FeatheringIdeaStartAudioProcessor::getKernelLength() const noexcept
+{
+    auto index = juce::jlimit(0, (int) LinearPhaseEngine::kernelLengths.size() - 1, juce::roundToInt(kernelLengthParam->load()));
+    return LinearPhaseEngine::kernelLengths[(size_t) index];
+}
 
-    juce::dsp::AudioBlock<float> block(buffer);
+int FeatheringIdeaStartAudioProcessor::getOversamplingFactor() const noexcept
+{
+    return juce::jlimit(0, OversamplingStage::maxFactor, juce::roundToInt(oversamplingParam->load()));
+}
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+OversamplingStage::FilterType FeatheringIdeaStartAudioProcessor::getOversamplingFilterType() const noexcept
+{
+    return juce::roundToInt(oversamplingFilterParam->load()) == OversamplingStage::linearPhaseFIR ? OversamplingStage::linearPhaseFIR
+                                                                                                  : OversamplingStage::polyphaseIIR;
+}
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-    
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+bool FeatheringIdeaStartAudioProcessor::isMorphing() const noexcept
+{
+    return snapshotMorphParam->load() >= 0.5f;
 }
 
-//==============================================================================
-bool FeatheringIdeaStartAudioProcessor::hasEditor() const
+BandSettings FeatheringIdeaStartAudioProcessor::getBandSettings(int band) const noexcept
 {
-    return true; // (change this to false if you choose to not supply an editor)
+    return isMorphing() ? snapshotBank.getMorphedBand(band, morphParam->load())
+                        : coefficientUpdater.getBandSettings(band);
 }
 
-juce::AudioProcessorEditor* FeatheringIdeaStartAudioProcessor::createEditor()
+CutSettingsArray FeatheringIdeaStartAudioProcessor::getCutSettings() const noexcept
 {
-    //return new FeatheringIdeaStartAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
+    CutSettingsArray cuts;
+
+    for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+        cuts[(size_t) cut] = { cutFreqParams[(size_t) cut]->load(), juce::roundToInt(cutSlopeParams[(size_t) cut]->load()) };
+
+    return cuts;
 }
 
-//==============================================================================
-void FeatheringIdeaStartAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+template <typename SampleType>
+int FeatheringIdeaStartAudioProcessor::updateBandTargets() noexcept
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    auto& engine = getFeatherEngine<SampleType>();
+
+    auto morphing = isMorphing();
+
+    // Whichever source takes over sends every band, and the engine crossfades if that's a jump
+    if (morphing != wasMorphing)
+    {
+        if (morphing)
+            snapshotBank.invalidateMorph();
+        else
+            coefficientUpdater.markAllBandsDirty();
+
+        wasMorphing = morphing;
+    }
+
+    if (! morphing)
+        return coefficientUpdater.updateDirtyBands(engine, responseCurve);
+
+    // The band parameters don't drive the bank while morphing
+    coefficientUpdater.discardDirtyBands();
+    return snapshotBank.updateMorph(morphParam->load(), engine, responseCurve);
 }
 
-void FeatheringIdeaStartAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+template <typename SampleType>
+bool FeatheringIdeaStartAudioProcessor::updateCutTargets() noexcept
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    auto cuts = getCutSettings();
+
+    if (cuts == currentCuts)
+        return false;
+
+    currentCuts = cuts;
+
+    for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+    {
+        getFeatherEngine<SampleType>().setCutTarget(cut, cuts[(size_t) cut]);
+        responseCurve.setCutTarget(cut, cuts[(size_t) cut]);
+    }
+
+    return true;
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void FeatheringIdeaStartAudioProcessor::updateLatency()
 {
-    ChainSettings settings;
+    setLatencySamples(isLinearPhase() ? getKernelLength() / 2
+                                      : oversampling.getLatencySamples(getOversamplingFactor(), getOversamplingFilterType()));
+}
 
-    settings.peak1Freq = apvts.getRawParameterValue("Freq 1")->load();
-    settings.peak2Freq = apvts.getRawParameterValue("Freq 2")->load();
-    settings.peak3Freq = apvts.getRawParameterValue("Freq 3")->load();
-    settings.peak4Freq = apvts.getRawParameterValue("Freq 4")->load();
+void FeatheringIdeaStartAudioProcessor::updateTail(double seconds) noexcept
+{
+    silenceGate.setTailSamples((juce::int64) std::ceil(seconds * getSampleRate()));
+    tailSeconds.store(seconds, std::memory_order_relaxed);
+}
+
+void FeatheringIdeaStartAudioProcessor::growReportedTail(double seconds) noexcept
+{
+    auto rounded = std::ceil(seconds / tailStepSeconds) * tailStepSeconds;
+    auto reported = reportedTailSeconds.load();
+
+    while (rounded > reported && ! reportedTailSeconds.compare_exchange_weak(reported, rounded))
+    {
+    }
+}
 
-    settings.peak1GainInDecibels = apvts.getRawParameterValue("Gain 1")->load();
-    settings.peak2GainInDecibels = apvts.getRawParameterValue("Gain 2")->load();
-    settings.peak3GainInDecibels = apvts.getRawParameterValue("Gain 3")->load();
-    settings.peak4GainInDecibels = apvts.getRawParameterValue("Gain 4")->load();
+void FeatheringIdeaStartAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    // Only the latency-affecting parameters are listened to here, and they may change on the
+    // audio thread, where posting to the message queue isn't safe, so just leave a flag for the timer
+    latencyChanged.store(true);
+}
 
-    settings.peak1Quality = apvts.getRawParameterValue("Q 1")->load();
-    settings.peak2Quality = apvts.getRawParameterValue("Q 2")->load();
-    settings.peak3Quality = apvts.getRawParameterValue("Q 3")->load();
-    settings.peak4Quality = apvts.getRawParameterValue("Q 4")->load();
+void FeatheringIdeaStartAudioProcessor::timerCallback()
+{
+    if (latencyChanged.exchange(false))
+        updateLatency();
 
-    return settings;
+    // There's no change flag for the tail alone, and flagging a latency change makes many hosts
+    // restart the plugin, so the tail is only raised here for the host to pick up when it next asks
+    growReportedTail(tailSeconds.load(std::memory_order_relaxed));
 }
 
-//STARTING WITH 4 Bands to Feather
+//Band count comes from FEATHERING_NUM_BANDS, starting with 4 bands to feather
 juce::AudioProcessorValueTreeState::ParameterLayout FeatheringIdeaStartAudioProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Freq 1",
-                                                           "Freq 1",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                            250.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Gain 1",
-                                                           "Gain 1",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Q 1",
-                                                           "Q 1",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Freq 2",
-                                                           "Freq 2",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                            500.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Gain 2",
-                                                           "Gain 2",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Q 2",
-                                                           "Q 2",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Freq 3",
-                                                           "Freq 3",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                            750.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Gain 3",
-                                                           "Gain 3",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Q 3",
-                                                           "Q 3",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Freq 4",
-                                                           "Freq 4",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                            1000.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Gain 4",
-                                                           "Gain 4",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Q 4",
-                                                           "Q 4",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
+    FeatherParameters::addBandParameters<numBands>(layout);
+    FeatherParameters::addCutParameters(layout);
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(FeatherParameters::phaseModeID,
+                                                            FeatherParameters::phaseModeID,
+                                                            juce::StringArray{ "Minimum Phase", "Linear Phase" },
+                                                            FeatherParameters::minimumPhase));
+
+    juce::StringArray kernelLengthChoices;
+
+    for (auto length : LinearPhaseEngine::kernelLengths)
+        kernelLengthChoices.add(juce::String(length));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(FeatherParameters::kernelLengthID,
+                                                            FeatherParameters::kernelLengthID,
+                                                            kernelLengthChoices,
+                                                            LinearPhaseEngine::defaultKernelLengthIndex));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(FeatherParameters::oversamplingID,
+                                                            FeatherParameters::oversamplingID,
+                                                            juce::StringArray{ "Off", "2x", "4x", "8x" },
+                                                            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(FeatherParameters::oversamplingFilterID,
+                                                            FeatherParameters::oversamplingFilterID,
+                                                            juce::StringArray{ "Polyphase IIR", "Linear-phase FIR" },
+                                                            OversamplingStage::polyphaseIIR));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(FeatherParameters::snapshotMorphID,
+                                                            FeatherParameters::snapshotMorphID,
+                                                            juce::StringArray{ "Off", "On" },
+                                                            0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(FeatherParameters::morphID,
+                                                           FeatherParameters::morphID,
+                                                           juce::NormalisableRange<float>(0.f, (float) (numSnapshots - 1)),
+                                                           0.f));
+
+    // Shared by every dynamic band, in milliseconds
+    layout.add(std::make_unique<juce::AudioParameterFloat>(FeatherParameters::attackID,
+                                                           FeatherParameters::attackID,
+                                                           juce::NormalisableRange<float>(0.1f, 200.f, 0.1f, 0.4f),
+                                                           5.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(FeatherParameters::releaseID,
+                                                           FeatherParameters::releaseID,
+                                                           juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.4f),
+                                                           100.f));
+
+    // Only the minimum-phase engine places bands; linear phase runs every band on every channel
+    layout.add(std::make_unique<juce::AudioParameterChoice>(FeatherParameters::channelModeID,
+                                                            FeatherParameters::channelModeID,
+                                                            juce::StringArray{ "Linked", "Independent", "Mid / Side" },
+                                                            FeatherParameters::linked));
+
     return layout;
 }
 
@@ -9,16 +9,22 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-struct ChainSettings
-{
-    float peak1Freq{ 0 }, peak1GainInDecibels{ 0 }, peak1Quality{ 1.f };
-    float peak2Freq{ 0 }, peak2GainInDecibels{ 0 }, peak2Quality{ 1.f };
-    float peak3Freq{ 0 }, peak3GainInDecibels{ 0 }, peak3Quality{ 1.f };
-    float peak4Freq{ 0 }, peak4GainInDecibels{ 0 }, peak4Quality{ 1.f };
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+#include "CoefficientUpdater.h"
+#include "CrossfadingEngine.h"
+#include "LinearPhaseEngine.h"
+#include "OversamplingStage.h"
+#include "PerformanceMonitor.h"
+#include "SpectrumAnalyzer.h"
+#include "ResponseCurve.h"
+#include "SilenceGate.h"
+#include "SnapshotBank.h"
+#include "StateSerializer.h"
+
+// Number of bands in the feathering bank. Parameters, settings and the engine are all generated
+// from it; override it in the project's preprocessor definitions to build larger banks.
+#ifndef FEATHERING_NUM_BANDS
+ #define FEATHERING_NUM_BANDS 4
+#endif
 
 //==============================================================================
 /**
@@ -27,8 +33,13 @@ class FeatheringIdeaStartAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::AudioProcessorValueTreeState::Listener
+                             , private juce::Timer
 {
 public:
+    static constexpr int numBands = FEATHERING_NUM_BANDS;
+    static constexpr int numSnapshots = SnapshotBank<numBands>::numSnapshots;
+
     //==============================================================================
     FeatheringIdeaStartAudioProcessor();
     ~FeatheringIdeaStartAudioProcessor() override;
@@ -42,6 +53,13 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // Clears the filters, e.g. when the host jumps, or between files in an offline render
+    void reset() override;
+
+    // Both precisions share the engine code; prepareToPlay sets up the one the host asked for
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -66,28 +84,132 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    void updateTrackProperties (const TrackProperties& properties) override;
+
+    // Audio-thread statistics; take snapshots from any other thread
+    PerformanceMonitor& getPerformanceMonitor() noexcept { return performanceMonitor; }
+
+    // Offline hosts: true while the linear-phase kernel for the current settings is still being
+    // designed and loaded. processBlock swaps it in, so keep processing until this clears.
+    bool isWaitingForKernel() const noexcept;
+
+    // Pre/post spectra for the editor; only fed while an editor is open
+    SpectrumAnalyzer& getAnalyzer() noexcept { return analyzer; }
+
+    // Combined band response for the editor, updated off the audio thread
+    ResponseCurveBase& getResponseCurve() noexcept { return responseCurve; }
+
+    // Message thread. Storing captures the band parameters; recalling sets them back, all at
+    // once, or moves the morph to the snapshot while morphing between snapshots.
+    void storeSnapshot(int snapshot);
+    void recallSnapshot(int snapshot);
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
 
 private:
+    CrossfadingEngine<numBands> featherEngine;
+    CrossfadingEngine<numBands, double> doubleFeatherEngine;
+
+    OversamplingStage oversampling;
 
-    using Filter = juce::dsp::IIR::Filter<float>;
-    
-    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-                                                //was CutFilter, Filter, Cutfilter
-    using MonoChain = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+    PerformanceMonitor performanceMonitor;
 
-    MonoChain leftChain, rightChain;
+    SilenceGate silenceGate;
 
-    enum ChainPositions
+    SpectrumAnalyzer analyzer;
+
+    ResponseCurve<numBands> responseCurve;
+
+    CoefficientUpdater<numBands> coefficientUpdater{ apvts };
+
+    SnapshotBank<numBands> snapshotBank;
+
+    StateSerializer stateSerializer{ apvts };
+
+    LinearPhaseEngine linearPhaseEngine{ numBands, [this](std::vector<BandSettings>& bands, CutSettingsArray& cuts)
+    {
+        for (int band = 0; band < numBands; ++band)
+            bands[(size_t) band] = getBandSettings(band);
+
+        cuts = getCutSettings();
+    } };
+
+    std::atomic<float>* phaseModeParam{ nullptr };
+    std::atomic<float>* kernelLengthParam{ nullptr };
+    std::atomic<float>* oversamplingParam{ nullptr };
+    std::atomic<float>* oversamplingFilterParam{ nullptr };
+    std::atomic<float>* snapshotMorphParam{ nullptr };
+    std::atomic<float>* morphParam{ nullptr };
+    std::atomic<float>* attackParam{ nullptr };
+    std::atomic<float>* releaseParam{ nullptr };
+    std::atomic<float>* channelModeParam{ nullptr };
+    std::array<std::atomic<float>*, (size_t) FeatherParameters::numCutTypes> cutFreqParams{}, cutSlopeParams{};
+    bool wasLinearPhase{ false }, wasMorphing{ false };
+
+    // The tail the filters have now, written by the audio thread and polled by the timer
+    std::atomic<double> tailSeconds{ 0.0 };
+
+    // What the host is told: the longest tail seen, rounded up to tailStepSeconds. It only ever
+    // grows, so a sweeping band can't make it flicker, and it's read by the host from any thread.
+    static constexpr double tailStepSeconds = 0.05;
+    std::atomic<double> reportedTailSeconds{ 0.0 };
+
+    // Set by the parameter listener on whichever thread the change came from, cleared by the timer
+    std::atomic<bool> latencyChanged{ false };
+
+    // Audio thread: the cut settings last sent to the engines and the response curve
+    CutSettingsArray currentCuts{};
+
+    bool isLinearPhase() const noexcept;
+    int getKernelLength() const noexcept;
+    int getOversamplingFactor() const noexcept;
+    OversamplingStage::FilterType getOversamplingFilterType() const noexcept;
+    bool isMorphing() const noexcept;
+
+    // The settings a band is currently heading for, from its parameters or from the morph. Any thread.
+    BandSettings getBandSettings(int band) const noexcept;
+
+    // Both cut filters, straight from their parameters. Any thread.
+    CutSettingsArray getCutSettings() const noexcept;
+
+    template <typename SampleType>
+    CrossfadingEngine<numBands, SampleType>& getFeatherEngine() noexcept
     {
-        Peak1,
-        Peak2,
-        Peak3,
-        Peak4
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleFeatherEngine;
+        else
+            return featherEngine;
+    }
+
+    template <typename SampleType>
+    void prepareMinimumPhase(const juce::dsp::ProcessSpec& spec);
+
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+
+    // Hands changed band settings, from the parameters or the morph, to the engine for
+    // SampleType and the response curve. Returns the number of bands sent.
+    template <typename SampleType>
+    int updateBandTargets() noexcept;
+
+    // Hands the cut settings to the engine for SampleType and the response curve if they have
+    // changed. Returns true if they had.
+    template <typename SampleType>
+    bool updateCutTargets() noexcept;
+
+    // Reports the latency of the current processing mode to the host. Message thread only.
+    void updateLatency();
+
+    // Audio thread: the current tail, for the silence gate and for the timer to pass on
+    void updateTail(double seconds) noexcept;
+
+    // Raises the reported tail to cover seconds, if it doesn't already
+    void growReportedTail(double seconds) noexcept;
 
-    };
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void timerCallback() override;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeatheringIdeaStartAudioProcessor)
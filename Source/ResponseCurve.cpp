@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+#include "CutFilter.h"
+
+bool ResponseCurveBase::getLatestCurve(std::vector<float>& destination)
+{
+    const juce::SpinLock::ScopedLockType sl(curveLock);
+
+    if (! hasNewCurve)
+        return false;
+
+    destination.swap(publishedCurve);
+    hasNewCurve = false;
+    return true;
+}
+
+float ResponseCurveBase::getGridFrequency(int index, int numPoints) noexcept
+{
+    return minFrequency * std::pow(maxFrequency / minFrequency, (float) index / (float) juce::jmax(1, numPoints));
+}
+
+void ResponseCurveBase::rebuildGrid(int numPoints, double rate)
+{
+    grid.numPoints = numPoints;
+    grid.rate = rate;
+
+    grid.frequency.resize((size_t) numPoints);
+    grid.s.resize((size_t) numPoints);
+    grid.sTimes1MinusS.resize((size_t) numPoints);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto frequency = getGridFrequency(i, numPoints);
+        grid.frequency[(size_t) i] = frequency;
+
+        if (rate > 0.0)
+        {
+            // Points above Nyquist pin there, as the cascade's response does
+            auto halfW = juce::MathConstants<double>::pi * juce::jmin((double) frequency, 0.5 * rate) / rate;
+            auto s = juce::square(std::sin(halfW));
+
+            grid.s[(size_t) i] = (float) s;
+            grid.sTimes1MinusS[(size_t) i] = (float) (s * (1.0 - s));
+        }
+    }
+}
+
+void ResponseCurveBase::publish(const std::vector<float>& total)
+{
+    const juce::SpinLock::ScopedLockType sl(curveLock);
+
+    // Copy rather than swap: total is re-summed in place next time
+    publishedCurve.resize(total.size());
+    std::copy(total.begin(), total.end(), publishedCurve.begin());
+    hasNewCurve = true;
+}
+
+void ResponseCurveBase::evaluateBand(const BandSettings& band, const Grid& curveGrid, float* decibels) noexcept
+{
+    auto numPoints = curveGrid.numPoints;
+    auto A2 = std::pow(10.0, band.gainInDecibels / 20.0);   // A^2
+
+    if (curveGrid.rate == analoguePrototype)
+    {
+        // |H|^2 = ((1 - w^2)^2 + (w A / Q)^2) / ((1 - w^2)^2 + (w / (A Q))^2), with w = f / fc
+        auto invCentre = 1.f / band.freq;
+        auto numeratorScale = (float) (A2 / juce::square(band.quality));
+        auto denominatorScale = (float) (1.0 / (A2 * juce::square(band.quality)));
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto w = curveGrid.frequency[(size_t) i] * invCentre;
+            auto w2 = w * w;
+            auto offCentre = (1.f - w2) * (1.f - w2);
+
+            decibels[i] = (offCentre + numeratorScale * w2) / (offCentre + denominatorScale * w2);
+        }
+    }
+    else
+    {
+        // Same clamp as makePeakSVF, so the curve shows what the cascade does
+        auto centre = juce::jmin((double) band.freq, 0.49 * curveGrid.rate);
+        auto w0 = juce::MathConstants<double>::twoPi * centre / curveGrid.rate;
+        auto sigma = (float) juce::square(std::sin(0.5 * w0));
+        auto alpha2 = juce::square(std::sin(w0) / (2.0 * band.quality));
+
+        auto numeratorScale = (float) (alpha2 * A2);
+        auto denominatorScale = (float) (alpha2 / A2);
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto d = curveGrid.s[(size_t) i] - sigma;
+            auto d2 = d * d;
+            auto q = curveGrid.sTimes1MinusS[(size_t) i];
+
+            decibels[i] = (d2 + numeratorScale * q) / (d2 + denominatorScale * q);
+        }
+    }
+
+    // The loops above produce |H|^2, so 10 log10 gives dB
+    for (int i = 0; i < numPoints; ++i)
+        decibels[i] = 10.f * std::log10(juce::jmax(decibels[i], 1.0e-12f));
+}
+
+void ResponseCurveBase::evaluateCut(int cut, const CutSettings& settings, const Grid& curveGrid, float* decibels) noexcept
+{
+    auto numPoints = curveGrid.numPoints;
+    auto order = 2 * CutFilter::getNumSections(settings.slope);
+    auto highPass = cut == FeatherParameters::lowCut;
+
+    // Squared ratio of each point's (warped) frequency to the corner's. Same clamp as getPrewarpedFrequency.
+    auto analogue = curveGrid.rate == analoguePrototype;
+    auto corner = analogue ? (double) settings.freq
+                           : std::tan(juce::MathConstants<double>::pi * juce::jlimit(1.0, 0.49 * curveGrid.rate, (double) settings.freq) / curveGrid.rate);
+    auto invCorner2 = 1.0 / (corner * corner);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        double ratio2;
+
+        if (analogue)
+        {
+            ratio2 = juce::square((double) curveGrid.frequency[(size_t) i]) * invCorner2;
+        }
+        else
+        {
+            auto s = (double) curveGrid.s[(size_t) i];
+            ratio2 = s / juce::jmax(1.0 - s, 1.0e-12) * invCorner2;
+        }
+
+        if (highPass)
+            ratio2 = 1.0 / juce::jmax(ratio2, 1.0e-30);
+
+        // |H|^2 = 1 / (1 + r^(2n))
+        auto magnitude2 = 1.0 / (1.0 + std::pow(ratio2, order));
+        decibels[i] = 10.f * std::log10(juce::jmax((float) magnitude2, 1.0e-12f));
+    }
+}
@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+
+    The combined magnitude response of all bands at display resolution, for
+    the editor. The audio thread publishes each band's new target as the
+    CoefficientUpdater hands it to the engine, along with the rate the
+    cascade is designed at; the shared background thread then re-evaluates
+    only the bands that changed, caches each band's curve in dB, and re-sums
+    the total.
+
+    Band curves are evaluated in batches over a log-frequency grid using the
+    bilinear bell's magnitude written in terms of s = sin^2(w/2):
+
+        |H|^2 = ((s - sigma)^2 + alpha^2 A^2 s(1 - s)) / ((s - sigma)^2 + alpha^2 / A^2 s(1 - s))
+
+    where sigma = sin^2(w0/2). That is exact for the cascade's bells, free of
+    the cancellation the cos(w)/cos(2w) form suffers at low frequencies and
+    high (oversampled) rates, and a straight-line loop the compiler
+    vectorises. In linear-phase mode the analogue prototype's magnitude is
+    used instead, since that is what the FIR kernels are designed from.
+
+    The cut filters are Butterworth, so their curves only need the ratio of
+    the warped frequency to the warped corner, tan^2(w/2) = s / (1 - s).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BackgroundThread.h"
+#include "BandMask.h"
+#include "FeatherParameters.h"
+
+//==============================================================================
+// The message-thread side, independent of the band count so components can hold one.
+class ResponseCurveBase  : protected juce::TimeSliceClient
+{
+public:
+    static constexpr float minFrequency = 20.f, maxFrequency = 20000.f;
+
+    // Marks a curve for the analogue prototype rather than a digital design rate
+    static constexpr double analoguePrototype = 0.0;
+
+    ResponseCurveBase() = default;
+
+    // Number of grid points, normally one per pixel column across the display
+    void setNumPoints(int numPoints) noexcept  { requestedNumPoints.store(juce::jmax(0, numPoints)); }
+
+    // Swaps the newest total response, in dB per grid point, into destination. Returns false,
+    // leaving destination alone, if nothing has changed since the last call.
+    bool getLatestCurve(std::vector<float>& destination);
+
+    // Frequency of grid point index out of numPoints, on the same log axis as the analyzer
+    static float getGridFrequency(int index, int numPoints) noexcept;
+
+protected:
+    // Grid in the forms the batch evaluation wants, for one design rate
+    struct Grid
+    {
+        std::vector<float> frequency;   // Hz
+        std::vector<float> s;           // sin^2(w/2) at the design rate
+        std::vector<float> sTimes1MinusS;
+
+        int numPoints{ 0 };
+        double rate{ -1.0 };
+    };
+
+    void rebuildGrid(int numPoints, double rate);
+    void publish(const std::vector<float>& total);
+
+    // Writes the band's or the cut filter's response in dB at every grid point
+    static void evaluateBand(const BandSettings& band, const Grid& grid, float* decibels) noexcept;
+    static void evaluateCut(int cut, const CutSettings& settings, const Grid& grid, float* decibels) noexcept;
+
+    juce::SharedResourcePointer<SharedBackgroundThread> backgroundThread;
+
+    std::atomic<int> requestedNumPoints{ 0 };
+    Grid grid;
+
+private:
+    juce::SpinLock curveLock;
+    std::vector<float> publishedCurve;
+    bool hasNewCurve{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResponseCurveBase)
+};
+
+//==============================================================================
+template <int NumBands>
+class ResponseCurve  : public ResponseCurveBase
+{
+public:
+    ResponseCurve()
+    {
+        dirtyBands.setAll();
+        backgroundThread->addTimeSliceClient(this);
+    }
+
+    ~ResponseCurve() override
+    {
+        backgroundThread->removeTimeSliceClient(this);
+    }
+
+    // Audio thread, from the coefficient update path. Same shape as FeatherEngine::setBandTarget
+    // so the CoefficientUpdater can feed both.
+    void setBandTarget(int band, const BandSettings& target) noexcept
+    {
+        auto& published = publishedBands[(size_t) band];
+
+        published.freq.store(target.freq, std::memory_order_relaxed);
+        published.gainInDecibels.store(target.gainInDecibels, std::memory_order_relaxed);
+        published.quality.store(target.quality, std::memory_order_relaxed);
+
+        dirtyBands.set(band);
+    }
+
+    // Audio thread, like setBandTarget
+    void setCutTarget(int cut, const CutSettings& target) noexcept
+    {
+        auto& published = publishedCuts[(size_t) cut];
+
+        published.freq.store(target.freq, std::memory_order_relaxed);
+        published.slope.store(target.slope, std::memory_order_relaxed);
+
+        cutsAreDirty.store(true);
+    }
+
+    // Audio thread: the rate the cascade is currently designed at, or analoguePrototype
+    void setDesignRate(double rate) noexcept
+    {
+        designRate.store(rate, std::memory_order_relaxed);
+    }
+
+private:
+    struct PublishedBand
+    {
+        std::atomic<float> freq{ 1000.f }, gainInDecibels{ 0.f }, quality{ 1.f };
+    };
+
+    struct PublishedCut
+    {
+        std::atomic<float> freq{ CutSettings().freq };
+        std::atomic<int> slope{ FeatherParameters::cutOff };
+    };
+
+    int useTimeSlice() override
+    {
+        constexpr int pollIntervalMs = 30;
+
+        auto numPoints = requestedNumPoints.load();
+        auto rate = designRate.load(std::memory_order_relaxed);
+
+        if (numPoints <= 0 || rate < 0.0)
+            return pollIntervalMs;
+
+        auto gridChanged = numPoints != grid.numPoints || rate != grid.rate;
+
+        if (gridChanged)
+        {
+            rebuildGrid(numPoints, rate);
+
+            for (auto& curve : bandDecibels)
+                curve.resize((size_t) numPoints);
+
+            for (auto& curve : cutDecibels)
+                curve.resize((size_t) numPoints);
+
+            total.resize((size_t) numPoints);
+            dirtyBands.setAll();
+            cutsAreDirty.store(true);
+        }
+
+        auto numChanged = dirtyBands.consume([this](int band)
+        {
+            const auto& published = publishedBands[(size_t) band];
+
+            BandSettings settings;
+            settings.freq = published.freq.load(std::memory_order_relaxed);
+            settings.gainInDecibels = published.gainInDecibels.load(std::memory_order_relaxed);
+            settings.quality = published.quality.load(std::memory_order_relaxed);
+
+            // A bell at 0 dB is flat, so it drops out of the sum without being evaluated
+            bandIsFlat[(size_t) band] = settings.gainInDecibels == 0.f;
+
+            if (! bandIsFlat[(size_t) band])
+                evaluateBand(settings, grid, bandDecibels[(size_t) band].data());
+        });
+
+        auto cutsChanged = cutsAreDirty.exchange(false);
+
+        if (cutsChanged)
+        {
+            for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+            {
+                const auto& published = publishedCuts[(size_t) cut];
+                CutSettings settings{ published.freq.load(std::memory_order_relaxed), published.slope.load(std::memory_order_relaxed) };
+
+                cutIsOff[(size_t) cut] = settings.slope == FeatherParameters::cutOff;
+
+                if (! cutIsOff[(size_t) cut])
+                    evaluateCut(cut, settings, grid, cutDecibels[(size_t) cut].data());
+            }
+        }
+
+        if (numChanged == 0 && ! cutsChanged)
+            return pollIntervalMs;
+
+        std::fill(total.begin(), total.end(), 0.f);
+
+        for (int band = 0; band < NumBands; ++band)
+            if (! bandIsFlat[(size_t) band])
+                juce::FloatVectorOperations::add(total.data(), bandDecibels[(size_t) band].data(), numPoints);
+
+        for (int cut = 0; cut < FeatherParameters::numCutTypes; ++cut)
+            if (! cutIsOff[(size_t) cut])
+                juce::FloatVectorOperations::add(total.data(), cutDecibels[(size_t) cut].data(), numPoints);
+
+        publish(total);
+        return pollIntervalMs;
+    }
+
+    std::array<PublishedBand, (size_t) NumBands> publishedBands;
+    AtomicBandMask<NumBands> dirtyBands;
+    std::array<PublishedCut, (size_t) FeatherParameters::numCutTypes> publishedCuts;
+    std::atomic<bool> cutsAreDirty{ true };
+    std::atomic<double> designRate{ -1.0 };
+
+    // Background thread only
+    std::array<std::vector<float>, (size_t) NumBands> bandDecibels;
+    std::array<bool, (size_t) NumBands> bandIsFlat{};
+    std::array<std::vector<float>, (size_t) FeatherParameters::numCutTypes> cutDecibels;
+    std::array<bool, (size_t) FeatherParameters::numCutTypes> cutIsOff{ true, true };
+    std::vector<float> total;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResponseCurve)
+};
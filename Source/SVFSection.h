@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    SVFSection.h
+
+    A second-order section in the trapezoidal (TPT) state-variable topology.
+    Unlike a direct-form biquad, its states stay well-behaved when the
+    coefficients change every few samples, which is what lets the bands be
+    swept at control rate without blowing up.
+
+    Every response is expressed as a mix of the SVF outputs:
+        y = m0 * input + m1 * bandpass + m2 * lowpass
+
+    Coefficients come in float, for the float engine and the approximate
+    designers, or double, for the double-precision engine.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <typename SampleType>
+struct BasicSVFCoefficients
+{
+    SampleType a1{ 1 }, a2{ 0 }, a3{ 0 };
+    SampleType m0{ 1 }, m1{ 0 }, m2{ 0 };
+
+    template <typename OtherType>
+    BasicSVFCoefficients<OtherType> as() const noexcept
+    {
+        return { (OtherType) a1, (OtherType) a2, (OtherType) a3, (OtherType) m0, (OtherType) m1, (OtherType) m2 };
+    }
+};
+
+using SVFCoefficients = BasicSVFCoefficients<float>;
+
+struct SVFState
+{
+    float ic1eq{ 0.f }, ic2eq{ 0.f };
+};
+
+// Bell (peak) response from its prewarped frequency g = tan(pi * f / fs) and amplitude A = 10^(dB / 40),
+// for callers that already have those to hand. Designed in double whatever the coefficient type.
+template <typename SampleType = float>
+inline BasicSVFCoefficients<SampleType> makePeakSVF(double g, float quality, double A) noexcept
+{
+    auto k = 1.0 / (quality * A);
+    auto a1 = 1.0 / (1.0 + g * (g + k));
+
+    BasicSVFCoefficients<double> c{ a1, g * a1, g * g * a1, 1.0, k * (A * A - 1.0), 0.0 };
+    return c.as<SampleType>();
+}
+
+inline double getPrewarpedFrequency(double sampleRate, float frequency) noexcept
+{
+    auto nyquistSafeFrequency = juce::jlimit(1.0, sampleRate * 0.49, (double) frequency);
+    return std::tan(juce::MathConstants<double>::pi * nyquistSafeFrequency / sampleRate);
+}
+
+// Bell (peak) response. Matches IIR::Coefficients::makePeakFilter for the same frequency, Q and gain.
+template <typename SampleType = float>
+inline BasicSVFCoefficients<SampleType> makePeakSVF(double sampleRate, float frequency, float quality, float gainInDecibels) noexcept
+{
+    return makePeakSVF<SampleType>(getPrewarpedFrequency(sampleRate, frequency), quality, std::pow(10.0, gainInDecibels / 40.0));
+}
+
+// Second-order low- and high-pass sections from their prewarped frequency, for the cut filters
+template <typename SampleType = float>
+inline BasicSVFCoefficients<SampleType> makeLowPassSVF(double g, double quality) noexcept
+{
+    auto k = 1.0 / quality;
+    auto a1 = 1.0 / (1.0 + g * (g + k));
+
+    BasicSVFCoefficients<double> c{ a1, g * a1, g * g * a1, 0.0, 0.0, 1.0 };
+    return c.as<SampleType>();
+}
+
+template <typename SampleType = float>
+inline BasicSVFCoefficients<SampleType> makeHighPassSVF(double g, double quality) noexcept
+{
+    auto k = 1.0 / quality;
+    auto a1 = 1.0 / (1.0 + g * (g + k));
+
+    BasicSVFCoefficients<double> c{ a1, g * a1, g * g * a1, 1.0, -k, -1.0 };
+    return c.as<SampleType>();
+}
+
+// Scalar reference for one sample. The cascade kernels in CascadeKernelImpl.h run the same
+// recurrence across SIMD lanes.
+inline float processSVFSample(const SVFCoefficients& c, SVFState& s, float v0) noexcept
+{
+    auto v3 = v0 - s.ic2eq;
+    auto v1 = c.a1 * s.ic1eq + c.a2 * v3;
+    auto v2 = s.ic2eq + c.a2 * s.ic1eq + c.a3 * v3;
+
+    s.ic1eq = 2.f * v1 - s.ic1eq;
+    s.ic2eq = 2.f * v2 - s.ic2eq;
+
+    return c.m0 * v0 + c.m1 * v1 + c.m2 * v2;
+}
+
+// Samples for a section's impulse response to decay by decayDecibels, from the radius of its poles.
+// Every TPT SVF response has its poles at the roots of (1 + gk + g^2) z^2 + 2 (g^2 - 1) z + (1 - gk + g^2),
+// where k is 1 / Q for the cut sections and 1 / (Q A) for a bell.
+inline double getSVFDecaySamples(double g, double k, double decayDecibels) noexcept
+{
+    auto a0 = 1.0 + g * (g + k);
+    auto b1 = 2.0 * (g * g - 1.0) / a0;
+    auto b2 = (1.0 - g * k + g * g) / a0;
+
+    auto discriminant = b1 * b1 - 4.0 * b2;
+    auto radius = discriminant < 0.0 ? std::sqrt(b2)
+                                     : 0.5 * (std::abs(b1) + std::sqrt(discriminant));
+
+    if (radius >= 1.0)
+        return std::numeric_limits<double>::infinity();
+
+    return decayDecibels * std::log(10.0) / 20.0 / -std::log(radius);
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SettingsExchange.h
+
+    Hands a complete set of settings from the message thread to the audio
+    thread in one piece, so the audio thread never sees half of an update.
+    The writer fills its back buffer and publishes it; the reader picks up
+    the newest published buffer at the start of a block. It is a double
+    buffer with a spare slot in the middle, which is what lets both sides
+    swap with a single atomic exchange instead of waiting for each other.
+
+    All buffers are allocated up front, and nothing here locks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <typename Settings>
+class SettingsExchange
+{
+public:
+    SettingsExchange() = default;
+
+    //==============================================================================
+    // Writer (one thread at a time): fill this in, then publish() it
+    Settings& getBackBuffer() noexcept  { return buffers[(size_t) backIndex]; }
+
+    void publish() noexcept
+    {
+        backIndex = middle.exchange(backIndex | newDataBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //==============================================================================
+    // Reader (the audio thread): the newest published settings, or nullptr if nothing has been
+    // published since the last call. The result stays valid until a later call returns another.
+    const Settings* pull() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & newDataBit) == 0)
+            return nullptr;
+
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        return &buffers[(size_t) frontIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3, newDataBit = 4;
+
+    std::array<Settings, 3> buffers{};
+
+    int backIndex{ 0 };                 // writer only
+    int frontIndex{ 1 };                // reader only
+    std::atomic<int> middle{ 2 };       // index of the buffer in flight, plus newDataBit
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SettingsExchange)
+};
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    SilenceGate.h
+
+    Decides when the processor can stop running its filters. Once the input
+    has been silent for longer than the filters' tail, whatever they still
+    hold has decayed out of hearing, so the gate goes idle: the output is
+    cleared and the engines are skipped until the input comes back, when
+    they restart from rest.
+
+    Silence is every sample below silenceThreshold, about -140 dBFS, which
+    covers digital silence and the dither floor of 24-bit sources.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SilenceGate
+{
+public:
+    static constexpr float silenceThreshold = 1.0e-7f;
+
+    SilenceGate() = default;
+
+    template <typename SampleType>
+    static bool isSilent(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer(channel), (int) block.getNumSamples());
+
+            if (range.getStart() < (SampleType) -silenceThreshold || range.getEnd() > (SampleType) silenceThreshold)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Back to listening, e.g. after prepare()
+    void reset() noexcept
+    {
+        numSilentSamples = 0;
+        idle = false;
+    }
+
+    // How long the input must stay silent before the gate goes idle. Safe to call every block.
+    void setTailSamples(juce::int64 newTailSamples) noexcept  { tailSamples = juce::jmax((juce::int64) 0, newTailSamples); }
+
+    // Counts a block of input in. Returns true if the block can be skipped: the input is silent
+    // and was silent for the whole of the tail before this block started.
+    bool update(bool inputIsSilent, int numSamples) noexcept
+    {
+        if (! inputIsSilent)
+        {
+            numSilentSamples = 0;
+            idle = false;
+            return false;
+        }
+
+        idle = numSilentSamples >= tailSamples;
+        numSilentSamples += numSamples;
+        return idle;
+    }
+
+    bool isIdle() const noexcept  { return idle; }
+
+private:
+    juce::int64 tailSamples{ 0 }, numSilentSamples{ 0 };
+    bool idle{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SilenceGate)
+};
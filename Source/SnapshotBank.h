@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    SnapshotBank.h
+
+    A fixed set of stored band configurations and the morph between them.
+    Snapshots are captured and saved on the message thread, in atomics so
+    the state can be written from any thread. Every change publishes the
+    whole bank to the audio thread through a SettingsExchange, already
+    converted to the perceptual domain (log frequency, dB gain, log Q, dB
+    threshold, log ratio), so a morph step is a lerp per value and three
+    exp2s per band. A band's placement can't be blended, so the morph takes
+    it from whichever snapshot is nearer.
+
+    The morph position runs from 0 (the first snapshot) to numSnapshots - 1
+    (the last), passing through each in turn.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FeatherParameters.h"
+#include "SettingsExchange.h"
+#include "StateSerializer.h"
+
+template <int NumBands>
+class SnapshotBank
+{
+public:
+    static constexpr int numBands = NumBands;
+    static constexpr int numSnapshots = 4;
+
+    SnapshotBank()
+    {
+        ChainSettings<NumBands> defaults;
+
+        for (int band = 0; band < numBands; ++band)
+            defaults.bands[(size_t) band].freq = FeatherParameters::getDefaultFreq(band);
+
+        for (int snapshot = 0; snapshot < numSnapshots; ++snapshot)
+            store(snapshot, defaults);
+
+        publish();
+    }
+
+    static juce::String getSnapshotName(int snapshot)  { return juce::String::charToString((juce::juce_wchar) ('A' + snapshot)); }
+
+    //==============================================================================
+    // Message thread
+
+    void store(int snapshot, const ChainSettings<NumBands>& settings) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(snapshot, numSnapshots));
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            auto& stored = getStoredBand(snapshot, band);
+            const auto& source = settings.bands[(size_t) band];
+
+            stored.freq.store(source.freq);
+            stored.gainInDecibels.store(source.gainInDecibels);
+            stored.quality.store(source.quality);
+            stored.thresholdInDecibels.store(source.thresholdInDecibels);
+            stored.ratio.store(source.ratio);
+            stored.placement.store((float) source.placement);
+        }
+    }
+
+    ChainSettings<NumBands> get(int snapshot) const noexcept
+    {
+        ChainSettings<NumBands> settings;
+
+        for (int band = 0; band < numBands; ++band)
+            settings.bands[(size_t) band] = getStoredSettings(snapshot, band);
+
+        return settings;
+    }
+
+    // Hands the stored snapshots to the audio thread. Call after storing or restoring.
+    void publish() noexcept
+    {
+        auto& bank = exchange.getBackBuffer();
+
+        for (int snapshot = 0; snapshot < numSnapshots; ++snapshot)
+            for (int band = 0; band < numBands; ++band)
+                bank[(size_t) snapshot][(size_t) band] = toPerceptual(getStoredSettings(snapshot, band));
+
+        exchange.publish();
+    }
+
+    // Saves the snapshots with the plugin state, as "Snapshot A Freq 1" and so on
+    void addToState(StateSerializer& serializer)
+    {
+        for (int snapshot = 0; snapshot < numSnapshots; ++snapshot)
+        {
+            auto prefix = "Snapshot " + getSnapshotName(snapshot) + " ";
+
+            for (int band = 0; band < numBands; ++band)
+            {
+                auto& stored = getStoredBand(snapshot, band);
+
+                serializer.addValue(prefix + FeatherParameters::getFreqID(band), stored.freq, stored.freq.load());
+                serializer.addValue(prefix + FeatherParameters::getGainID(band), stored.gainInDecibels, stored.gainInDecibels.load());
+                serializer.addValue(prefix + FeatherParameters::getQualityID(band), stored.quality, stored.quality.load());
+                serializer.addValue(prefix + FeatherParameters::getThresholdID(band), stored.thresholdInDecibels, stored.thresholdInDecibels.load());
+                serializer.addValue(prefix + FeatherParameters::getRatioID(band), stored.ratio, stored.ratio.load());
+                serializer.addValue(prefix + FeatherParameters::getPlacementID(band), stored.placement, stored.placement.load());
+            }
+        }
+    }
+
+    //==============================================================================
+    // Any thread: one band of the morph, straight from the stored snapshots
+    BandSettings getMorphedBand(int band, float position) const noexcept
+    {
+        auto [first, amount] = splitPosition(position);
+
+        return fromPerceptual(interpolate(toPerceptual(getStoredSettings(first, band)),
+                                          toPerceptual(getStoredSettings(juce::jmin(first + 1, numSnapshots - 1), band)),
+                                          amount));
+    }
+
+    //==============================================================================
+    // Audio thread: sends every band's morphed settings to each target if the position or the
+    // snapshots have changed since the last call, and returns the number of bands sent.
+    template <typename... Targets>
+    int updateMorph(float position, Targets&... targets) noexcept
+    {
+        if (auto* newBank = exchange.pull())
+            bank = newBank;
+        else if (position == lastPosition || bank == nullptr)
+            return 0;
+
+        lastPosition = position;
+
+        auto [first, amount] = splitPosition(position);
+        const auto& from = (*bank)[(size_t) first];
+        const auto& to = (*bank)[(size_t) juce::jmin(first + 1, numSnapshots - 1)];
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            auto settings = fromPerceptual(interpolate(from[(size_t) band], to[(size_t) band], amount));
+            (targets.setBandTarget(band, settings), ...);
+        }
+
+        return numBands;
+    }
+
+    // Audio thread: makes the next updateMorph() send the bands even if nothing has moved
+    void invalidateMorph() noexcept  { lastPosition = -1.f; }
+
+private:
+    struct StoredBand
+    {
+        std::atomic<float> freq{ 1000.f }, gainInDecibels{ 0.f }, quality{ 1.f };
+        std::atomic<float> thresholdInDecibels{ -24.f }, ratio{ 1.f };
+        std::atomic<float> placement{ 0.f };
+    };
+
+    struct PerceptualBand
+    {
+        float log2Freq, gainInDecibels, log2Quality;
+        float thresholdInDecibels, log2Ratio;
+        int placement;
+    };
+
+    using PerceptualBank = std::array<std::array<PerceptualBand, (size_t) NumBands>, (size_t) numSnapshots>;
+
+    StoredBand& getStoredBand(int snapshot, int band) noexcept
+    {
+        return storedBands[(size_t) (snapshot * numBands + band)];
+    }
+
+    BandSettings getStoredSettings(int snapshot, int band) const noexcept
+    {
+        const auto& stored = storedBands[(size_t) (snapshot * numBands + band)];
+        return { stored.freq.load(), stored.gainInDecibels.load(), stored.quality.load(),
+                 stored.thresholdInDecibels.load(), stored.ratio.load(), juce::roundToInt(stored.placement.load()) };
+    }
+
+    static PerceptualBand toPerceptual(const BandSettings& settings) noexcept
+    {
+        return { std::log2(settings.freq), settings.gainInDecibels, std::log2(settings.quality),
+                 settings.thresholdInDecibels, std::log2(settings.ratio), settings.placement };
+    }
+
+    static BandSettings fromPerceptual(const PerceptualBand& band) noexcept
+    {
+        return { std::exp2(band.log2Freq), band.gainInDecibels, std::exp2(band.log2Quality),
+                 band.thresholdInDecibels, std::exp2(band.log2Ratio), band.placement };
+    }
+
+    static PerceptualBand interpolate(const PerceptualBand& a, const PerceptualBand& b, float amount) noexcept
+    {
+        return { a.log2Freq + amount * (b.log2Freq - a.log2Freq),
+                 a.gainInDecibels + amount * (b.gainInDecibels - a.gainInDecibels),
+                 a.log2Quality + amount * (b.log2Quality - a.log2Quality),
+                 a.thresholdInDecibels + amount * (b.thresholdInDecibels - a.thresholdInDecibels),
+                 a.log2Ratio + amount * (b.log2Ratio - a.log2Ratio),
+                 amount < 0.5f ? a.placement : b.placement };
+    }
+
+    // The snapshot at or below the position, and how far it is towards the next one
+    static std::pair<int, float> splitPosition(float position) noexcept
+    {
+        position = juce::jlimit(0.f, (float) (numSnapshots - 1), position);
+
+        auto first = juce::jmin((int) position, numSnapshots - 1);
+        return { first, position - (float) first };
+    }
+
+    std::array<StoredBand, (size_t) (numSnapshots * NumBands)> storedBands;
+
+    SettingsExchange<PerceptualBank> exchange;
+
+    // Audio thread only
+    const PerceptualBank* bank{ nullptr };
+    float lastPosition{ -1.f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SnapshotBank)
+};
@@ -0,0 +1,286 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+void AnalyzerFifo::prepare(int numChannels, int capacity)
+{
+    buffer.setSize(numChannels, capacity);
+    fifo.setTotalSize(capacity);
+    fifo.reset();
+}
+
+template <typename SampleType>
+void AnalyzerFifo::push(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    auto numChannels = juce::jmin((int) block.getNumChannels(), buffer.getNumChannels());
+    auto numToWrite = juce::jmin((int) block.getNumSamples(), fifo.getFreeSpace());
+
+    if (numChannels == 0 || numToWrite <= 0)
+        return;
+
+    const auto scope = fifo.write(numToWrite);
+
+    auto copyRegion = [](float* destination, const SampleType* source, int size)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            juce::FloatVectorOperations::copy(destination, source, size);
+        else
+            for (int i = 0; i < size; ++i)
+                destination[i] = (float) source[i];
+    };
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* source = block.getChannelPointer((size_t) channel);
+
+        if (scope.blockSize1 > 0)
+            copyRegion(buffer.getWritePointer(channel, scope.startIndex1), source, scope.blockSize1);
+
+        if (scope.blockSize2 > 0)
+            copyRegion(buffer.getWritePointer(channel, scope.startIndex2), source + scope.blockSize1, scope.blockSize2);
+    }
+}
+
+template void AnalyzerFifo::push<float>(const juce::dsp::AudioBlock<float>&) noexcept;
+template void AnalyzerFifo::push<double>(const juce::dsp::AudioBlock<double>&) noexcept;
+
+int AnalyzerFifo::pullMono(float* mono, int maxSamples) noexcept
+{
+    auto numChannels = buffer.getNumChannels();
+    auto numToRead = juce::jmin(maxSamples, fifo.getNumReady());
+
+    if (numChannels == 0 || numToRead <= 0)
+        return 0;
+
+    const auto scope = fifo.read(numToRead);
+    auto gain = 1.f / (float) numChannels;
+
+    auto mixRegion = [&](int start, int size, float* destination)
+    {
+        if (size <= 0)
+            return;
+
+        juce::FloatVectorOperations::copyWithMultiply(destination, buffer.getReadPointer(0, start), gain, size);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(channel, start), gain, size);
+    };
+
+    mixRegion(scope.startIndex1, scope.blockSize1, mono);
+    mixRegion(scope.startIndex2, scope.blockSize2, mono + scope.blockSize1);
+
+    return numToRead;
+}
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer()
+{
+    backgroundThread->addTimeSliceClient(this);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    backgroundThread->removeTimeSliceClient(this);
+}
+
+void SpectrumAnalyzer::prepare(double newSampleRate, int numChannels)
+{
+    const juce::ScopedLock sl(analysisLock);
+
+    sampleRate = newSampleRate;
+
+    // Enough to ride out a couple of hundred milliseconds between background slices
+    auto capacity = juce::jmax(2 * fftSize, juce::roundToInt(sampleRate * 0.2));
+
+    for (auto& tap : taps)
+    {
+        tap.fifo.prepare(juce::jmax(1, numChannels), capacity);
+        tap.history.assign((size_t) fftSize, 0.f);
+        tap.historyPosition = 0;
+        tap.newSamples = 0;
+        tap.smoothedDecibels.assign((size_t) (fftSize / 2 + 1), minDecibels);
+    }
+
+    fftData.assign((size_t) (2 * fftSize), 0.f);
+    pullBuffer.assign((size_t) capacity, 0.f);
+
+    // Bin ranges depend on the sample rate
+    columnBinsWidth = 0;
+}
+
+void SpectrumAnalyzer::setActive(bool shouldBeActive)
+{
+    isActive.store(shouldBeActive);
+
+    if (shouldBeActive)
+        backgroundThread->moveToFrontOfQueue(this);
+}
+
+void SpectrumAnalyzer::setDisplaySize(int width, int height)
+{
+    displayWidth.store(juce::jmax(0, width));
+    displayHeight.store(juce::jmax(0, height));
+}
+
+bool SpectrumAnalyzer::getLatestPath(Tap tapIndex, juce::Path& destination)
+{
+    auto& tap = taps[(size_t) tapIndex];
+    const juce::SpinLock::ScopedLockType sl(pathLock);
+
+    if (! tap.hasNewPath)
+        return false;
+
+    // Swapping hands the caller's old path back for reuse, so neither side allocates
+    destination.swapWithPath(tap.publishedPath);
+    tap.hasNewPath = false;
+    return true;
+}
+
+float SpectrumAnalyzer::frequencyToX(float frequency, float width) noexcept
+{
+    return width * std::log(frequency / minFrequency) / std::log(maxFrequency / minFrequency);
+}
+
+float SpectrumAnalyzer::decibelsToY(float decibels, float height) noexcept
+{
+    return juce::jmap(juce::jlimit(minDecibels, maxDecibels, decibels), minDecibels, maxDecibels, height, 0.f);
+}
+
+//==============================================================================
+int SpectrumAnalyzer::useTimeSlice()
+{
+    constexpr int activeIntervalMs = 15, idleIntervalMs = 100;
+
+    if (! isActive.load())
+        return idleIntervalMs;
+
+    const juce::ScopedLock sl(analysisLock);
+
+    if (fftData.empty())
+        return idleIntervalMs;
+
+    auto width = displayWidth.load();
+
+    if (width != columnBinsWidth)
+        updateColumnBins(width);
+
+    for (auto& tap : taps)
+        analyse(tap);
+
+    return activeIntervalMs;
+}
+
+void SpectrumAnalyzer::analyse(TapState& tap)
+{
+    for (int numPulled; (numPulled = tap.fifo.pullMono(pullBuffer.data(), (int) pullBuffer.size())) > 0;)
+    {
+        for (int i = 0; i < numPulled; ++i)
+        {
+            tap.history[(size_t) tap.historyPosition] = pullBuffer[(size_t) i];
+            tap.historyPosition = (tap.historyPosition + 1) % fftSize;
+        }
+
+        tap.newSamples += numPulled;
+    }
+
+    if (tap.newSamples < hopSize)
+        return;
+
+    // Only the newest window is analysed; a display refresh doesn't need every hop
+    for (int i = 0; i < fftSize; ++i)
+        fftData[(size_t) i] = tap.history[(size_t) ((tap.historyPosition + i) % fftSize)];
+
+    std::fill(fftData.begin() + fftSize, fftData.end(), 0.f);
+
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // Peaks hold and then fall at a fixed rate, however often frames arrive
+    constexpr float fallDecibelsPerSecond = 40.f;
+    auto fall = fallDecibelsPerSecond * (float) (tap.newSamples / sampleRate);
+    tap.newSamples = 0;
+
+    // A full-scale sine reads 0 dB
+    auto scale = 2.f / (float) fftSize;
+
+    for (size_t bin = 0; bin < tap.smoothedDecibels.size(); ++bin)
+    {
+        auto decibels = juce::Decibels::gainToDecibels(fftData[bin] * scale, minDecibels);
+        tap.smoothedDecibels[bin] = juce::jmax(decibels, tap.smoothedDecibels[bin] - fall);
+    }
+
+    buildPath(tap, &tap == &taps[pre]);
+}
+
+void SpectrumAnalyzer::buildPath(TapState& tap, bool closeForFill)
+{
+    auto width = columnBinsWidth;
+    auto height = (float) displayHeight.load();
+
+    if (width <= 0 || height <= 0.f)
+        return;
+
+    auto& path = tap.workingPath;
+    path.clear();
+
+    // One point per pixel column, taking the loudest bin under it
+    for (int x = 0; x < width; ++x)
+    {
+        auto [firstBin, lastBin] = columnBins[(size_t) x];
+        auto decibels = *std::max_element(tap.smoothedDecibels.begin() + firstBin, tap.smoothedDecibels.begin() + lastBin + 1);
+        auto y = decibelsToY(decibels, height);
+
+        if (x == 0)
+            path.startNewSubPath(0.f, y);
+        else
+            path.lineTo((float) x, y);
+    }
+
+    if (closeForFill)
+    {
+        path.lineTo((float) width, height);
+        path.lineTo(0.f, height);
+        path.closeSubPath();
+    }
+
+    const juce::SpinLock::ScopedLockType sl(pathLock);
+    tap.publishedPath.swapWithPath(path);
+    tap.hasNewPath = true;
+}
+
+void SpectrumAnalyzer::updateColumnBins(int width)
+{
+    columnBins.resize((size_t) juce::jmax(0, width));
+    columnBinsWidth = width;
+
+    constexpr int lastBin = fftSize / 2;
+    auto binsPerHz = fftSize / sampleRate;
+
+    auto getFrequency = [width](int x)
+    {
+        return minFrequency * std::pow(maxFrequency / minFrequency, (float) x / (float) width);
+    };
+
+    for (int x = 0; x < width; ++x)
+    {
+        auto first = juce::jlimit(0, lastBin, (int) (getFrequency(x) * binsPerHz));
+        auto last = juce::jlimit(first, lastBin, (int) std::ceil(getFrequency(x + 1) * binsPerHz) - 1);
+        columnBins[(size_t) x] = { first, last };
+    }
+
+    // Room for a point per column plus closing the fill, so building paths doesn't allocate
+    for (auto& tap : taps)
+    {
+        tap.workingPath.preallocateSpace(3 * (width + 3));
+
+        const juce::SpinLock::ScopedLockType sl(pathLock);
+        tap.publishedPath.preallocateSpace(3 * (width + 3));
+    }
+}
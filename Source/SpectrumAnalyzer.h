@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Pre/post spectrum analysis for the editor. The audio thread's only job is
+    to copy each block into a lock-free single-producer FIFO per tap, and it
+    only does that while an editor is open. Everything else happens on the
+    shared background thread: windowing, the FFT, peak-hold smoothing, and
+    turning the spectrum into a Path at the display's resolution. The
+    message thread just swaps in the finished paths and strokes them.
+
+    All buffers, including the paths' storage, are allocated in prepare()
+    and setDisplaySize(), so steady-state analysis doesn't allocate either.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BackgroundThread.h"
+
+//==============================================================================
+// Single-producer, single-consumer FIFO of multichannel audio. Writes drop what doesn't fit
+// rather than wait, since a dropped analyzer frame is invisible and a blocked audio thread isn't.
+class AnalyzerFifo
+{
+public:
+    AnalyzerFifo() = default;
+
+    // Not thread-safe: call while neither end is running.
+    void prepare(int numChannels, int capacity);
+
+    // Producer: the audio thread. Double-precision blocks are stored as float.
+    template <typename SampleType>
+    void push(const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    // Consumer: reads up to maxSamples into mono, averaging the channels. Returns the number read.
+    int pullMono(float* mono, int maxSamples) noexcept;
+
+    void clear() noexcept { fifo.reset(); }
+
+private:
+    juce::AbstractFifo fifo{ 1 };
+    juce::AudioBuffer<float> buffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalyzerFifo)
+};
+
+//==============================================================================
+class SpectrumAnalyzer  : private juce::TimeSliceClient
+{
+public:
+    enum Tap
+    {
+        pre,
+        post,
+        numTaps
+    };
+
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+
+    static constexpr float minFrequency = 20.f, maxFrequency = 20000.f;
+    static constexpr float minDecibels = -90.f, maxDecibels = 12.f;
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer() override;
+
+    // Message thread, while the audio thread isn't running
+    void prepare(double sampleRate, int numChannels);
+
+    // Audio thread: a copy into the tap's FIFO, and nothing at all while no editor is open
+    template <typename SampleType>
+    void push(Tap tap, const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        if (isActive.load(std::memory_order_relaxed))
+            taps[(size_t) tap].fifo.push(block);
+    }
+
+    //==============================================================================
+    // Message thread
+
+    // An open editor turns analysis on; closing it turns it off again.
+    void setActive(bool shouldBeActive);
+
+    // Size of the area the paths are drawn into
+    void setDisplaySize(int width, int height);
+
+    // Swaps the newest path for the tap into destination. Returns false, leaving destination
+    // alone, if nothing new has been analysed since the last call.
+    bool getLatestPath(Tap tap, juce::Path& destination);
+
+    // Mapping shared with the editor's grid
+    static float frequencyToX(float frequency, float width) noexcept;
+    static float decibelsToY(float decibels, float height) noexcept;
+
+private:
+    struct TapState
+    {
+        AnalyzerFifo fifo;
+
+        std::vector<float> history;      // circular, fftSize samples
+        int historyPosition{ 0 }, newSamples{ 0 };
+
+        std::vector<float> smoothedDecibels;
+        juce::Path workingPath, publishedPath;
+        bool hasNewPath{ false };
+    };
+
+    int useTimeSlice() override;
+
+    void analyse(TapState& tap);
+    void buildPath(TapState& tap, bool closeForFill);
+    void updateColumnBins(int width);
+
+    juce::SharedResourcePointer<SharedBackgroundThread> backgroundThread;
+
+    std::array<TapState, (size_t) numTaps> taps;
+
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, true };
+    std::vector<float> fftData, pullBuffer;
+
+    // For each pixel column, the range of FFT bins it covers
+    std::vector<std::pair<int, int>> columnBins;
+    int columnBinsWidth{ 0 };
+
+    std::atomic<bool> isActive{ false };
+    std::atomic<int> displayWidth{ 0 }, displayHeight{ 0 };
+
+    // Background thread and prepare() share the analysis state; the message thread and the
+    // background thread share the published paths. The audio thread takes neither.
+    juce::CriticalSection analysisLock;
+    juce::SpinLock pathLock;
+
+    double sampleRate{ 44100.0 };
+    juce::uint32 lastAnalysisTime{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzer)
+};
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    StateSerializer.cpp
+
+  ==============================================================================
+*/
+
+#include "StateSerializer.h"
+
+namespace
+{
+    constexpr std::array<juce::uint32, 256> makeCrcTable() noexcept
+    {
+        std::array<juce::uint32, 256> table{};
+
+        for (juce::uint32 i = 0; i < 256; ++i)
+        {
+            auto crc = i;
+
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) != 0 ? 0xedb88320 ^ (crc >> 1) : crc >> 1;
+
+            table[i] = crc;
+        }
+
+        return table;
+    }
+
+    constexpr auto crcTable = makeCrcTable();
+
+    void writeUint32(juce::uint8* destination, juce::uint32 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(destination, &value, sizeof(value));
+    }
+
+    void writeUint16(juce::uint8* destination, juce::uint16 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(destination, &value, sizeof(value));
+    }
+
+    void writeFloat(juce::uint8* destination, float value) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeUint32(destination, bits);
+    }
+
+    float readFloat(const juce::uint8* source) noexcept
+    {
+        auto bits = juce::ByteOrder::littleEndianInt(source);
+
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+//==============================================================================
+StateSerializer::StateSerializer(juce::AudioProcessorValueTreeState& state)
+    : apvts(state)
+{
+    for (auto* parameter : apvts.processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            auto* value = apvts.getRawParameterValue(ranged->paramID);
+            jassert(value != nullptr);
+
+            parameters.push_back({ hashParameterID(ranged->paramID), ranged, value,
+                                   ranged->convertFrom0to1(ranged->getDefaultValue()) });
+        }
+    }
+
+    std::sort(parameters.begin(), parameters.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+    checkForHashCollisions();
+
+    restored.resize(parameters.size());
+}
+
+void StateSerializer::addValue(const juce::String& id, std::atomic<float>& value, float defaultValue)
+{
+    Entry entry{ hashParameterID(id), nullptr, &value, defaultValue };
+
+    auto position = std::upper_bound(parameters.begin(), parameters.end(), entry.hash,
+                                     [](juce::uint32 h, const Entry& e) { return h < e.hash; });
+
+    parameters.insert(position, entry);
+    checkForHashCollisions();
+
+    restored.resize(parameters.size());
+}
+
+void StateSerializer::write(juce::MemoryBlock& destination) const
+{
+    destination.setSize(getBinarySize());
+    auto* data = static_cast<juce::uint8*>(destination.getData());
+
+    writeUint32(data, magic);
+    writeUint16(data + 4, formatVersion);
+    writeUint16(data + 6, (juce::uint16) entrySize);
+    writeUint32(data + 8, (juce::uint32) parameters.size());
+
+    auto* entry = data + headerSize;
+
+    for (const auto& parameter : parameters)
+    {
+        writeUint32(entry, parameter.hash);
+        writeFloat(entry + 4, parameter.value->load());
+        entry += entrySize;
+    }
+
+    writeUint32(entry, crc32(data, (size_t) (entry - data)));
+}
+
+StateSerializer::Result StateSerializer::read(const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < 4)
+        return Result::rejected;
+
+    if (juce::ByteOrder::littleEndianInt(data) == magic)
+        return readBinary(static_cast<const juce::uint8*>(data), (size_t) sizeInBytes) ? Result::restoredBinary
+                                                                                         : Result::rejected;
+
+    return readXml(data, sizeInBytes) ? Result::restoredXml : Result::rejected;
+}
+
+bool StateSerializer::readBinary(const juce::uint8* data, size_t numBytes)
+{
+    if (numBytes < headerSize + checksumSize)
+        return false;
+
+    auto version = juce::ByteOrder::littleEndianShort(data + 4);
+    auto bytesPerEntry = (size_t) juce::ByteOrder::littleEndianShort(data + 6);
+    auto numEntries = (size_t) juce::ByteOrder::littleEndianInt(data + 8);
+
+    if (version == 0 || bytesPerEntry < entrySize
+         || numBytes != headerSize + numEntries * bytesPerEntry + checksumSize)
+        return false;
+
+    auto checksumOffset = numBytes - checksumSize;
+
+    if (crc32(data, checksumOffset) != juce::ByteOrder::littleEndianInt(data + checksumOffset))
+        return false;
+
+    std::fill(restored.begin(), restored.end(), false);
+
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        auto* entry = data + headerSize + i * bytesPerEntry;
+        auto hash = juce::ByteOrder::littleEndianInt(entry);
+
+        auto found = std::lower_bound(parameters.begin(), parameters.end(), hash,
+                                      [](const Entry& e, juce::uint32 h) { return e.hash < h; });
+
+        // Parameters this build doesn't have are skipped
+        if (found == parameters.end() || found->hash != hash)
+            continue;
+
+        auto value = readFloat(entry + 4);
+
+        if (std::isfinite(value))
+        {
+            setIfChanged(*found, value);
+            restored[(size_t) (found - parameters.begin())] = true;
+        }
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+        if (! restored[i])
+            setIfChanged(parameters[i], parameters[i].defaultValue);
+
+    return true;
+}
+
+bool StateSerializer::readXml(const void* data, int sizeInBytes)
+{
+    auto xml = juce::AudioProcessor::getXmlFromBinary(data, sizeInBytes);
+
+    if (xml == nullptr || ! xml->hasTagName(apvts.state.getType().toString()))
+        return false;
+
+    apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    return true;
+}
+
+void StateSerializer::setIfChanged(const Entry& entry, float plainValue)
+{
+    if (entry.parameter == nullptr)
+    {
+        entry.value->store(plainValue);
+        return;
+    }
+
+    auto normalised = entry.parameter->convertTo0to1(plainValue);
+
+    // Unchanged parameters are left alone, which spares the host a notification for each
+    if (normalised != entry.parameter->getValue())
+        entry.parameter->setValueNotifyingHost(normalised);
+}
+
+void StateSerializer::checkForHashCollisions() const
+{
+    // Two IDs hashing alike would make their entries indistinguishable; rename one of them
+    jassert(std::adjacent_find(parameters.begin(), parameters.end(),
+                               [](const Entry& a, const Entry& b) { return a.hash == b.hash; }) == parameters.end());
+}
+
+//==============================================================================
+juce::uint32 StateSerializer::hashParameterID(const juce::String& parameterID) noexcept
+{
+    // FNV-1a over the UTF-8 bytes
+    juce::uint32 hash = 0x811c9dc5;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+        hash = (hash ^ (juce::uint8) *c) * 0x01000193;
+
+    return hash;
+}
+
+juce::uint32 StateSerializer::crc32(const void* data, size_t numBytes) noexcept
+{
+    auto* bytes = static_cast<const juce::uint8*>(data);
+    juce::uint32 crc = 0xffffffff;
+
+    for (size_t i = 0; i < numBytes; ++i)
+        crc = crcTable[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+
+    return crc ^ 0xffffffff;
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    StateSerializer.h
+
+    Compact, versioned binary plugin state. Every parameter is stored as a
+    hash of its ID and its plain (not normalised) value, so a blob stays
+    valid when parameters are added, removed or re-ranged, and restoring is
+    a sorted lookup per entry rather than parsing XML. Layout, little-endian:
+
+        uint32  magic, "FTHS"
+        uint16  format version
+        uint16  bytes per entry
+        uint32  number of entries
+        entries of { uint32 FNV-1a hash of the parameter ID, float32 value }
+        uint32  CRC-32 of everything before it
+
+    Later versions may only append fields to an entry, so older builds can
+    still read newer blobs by skipping what they don't know. Blobs that fail
+    the checks are rejected without touching any parameter. Anything without
+    the magic is tried as the APVTS XML that JUCE's helpers write, which is
+    how older or hand-made states migrate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class StateSerializer
+{
+public:
+    static constexpr juce::uint32 magic = 0x53485446;   // "FTHS" in little-endian byte order
+    static constexpr juce::uint16 formatVersion = 1;
+
+    static constexpr size_t headerSize = 12, entrySize = 8, checksumSize = 4;
+
+    enum class Result
+    {
+        restoredBinary,
+        restoredXml,
+        rejected
+    };
+
+    // Indexes the state's parameters; they must all exist by now.
+    explicit StateSerializer(juce::AudioProcessorValueTreeState& state);
+
+    // Saves a value that isn't a parameter, such as a stored snapshot, under its own ID. The value
+    // must outlive the serializer; restoring a blob without it puts it back to defaultValue.
+    void addValue(const juce::String& id, std::atomic<float>& value, float defaultValue);
+
+    // Any thread: reads the parameters' current values
+    void write(juce::MemoryBlock& destination) const;
+    size_t getBinarySize() const noexcept  { return headerSize + parameters.size() * entrySize + checksumSize; }
+
+    // Message thread. Parameters the blob doesn't mention go back to their defaults, so a
+    // recall always lands on exactly the saved state.
+    Result read(const void* data, int sizeInBytes);
+
+    static juce::uint32 hashParameterID(const juce::String& parameterID) noexcept;
+    static juce::uint32 crc32(const void* data, size_t numBytes) noexcept;
+
+private:
+    struct Entry
+    {
+        juce::uint32 hash;
+        juce::RangedAudioParameter* parameter;      // nullptr for values added with addValue()
+        std::atomic<float>* value;
+        float defaultValue;
+    };
+
+    bool readBinary(const juce::uint8* data, size_t numBytes);
+    bool readXml(const void* data, int sizeInBytes);
+
+    static void setIfChanged(const Entry& entry, float plainValue);
+    void checkForHashCollisions() const;
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    std::vector<Entry> parameters;          // sorted by hash, parameters and added values alike
+    std::vector<bool> restored;             // scratch for read(), one per entry
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StateSerializer)
+};
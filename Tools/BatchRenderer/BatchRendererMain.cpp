@@ -0,0 +1,500 @@
+/*
+  ==============================================================================
+
+    BatchRendererMain.cpp
+
+    Headless offline renderer. Loads a saved plugin state and runs WAV and
+    AIFF files through the plugin processor, writing each to the output
+    directory in the same format, bit depth and length as its input.
+    Directories given as inputs are searched recursively, and their layout
+    is kept under the output directory.
+
+    Files are rendered in parallel, one processor per worker thread. The
+    workers take files from a shared cursor over the list sorted largest
+    first, so the long files start early and the short ones fill in the
+    gaps at the end. Inputs are read through memory-mapped readers where
+    the format has one, and everything streams in large blocks through a
+    single buffer per worker, so no file is ever loaded whole.
+
+    The processor's latency is compensated: the first latency samples of
+    output are dropped and the input is padded with as many zeros at the
+    end. A linear-phase kernel is designed in the background, so a worker
+    warms its processor up until the kernel is in before rendering.
+
+    Throughput is reported per file and overall as a multiple of real time,
+    along with how busy the workers were, which is what limits scaling.
+
+    Usage: FeatheringBatchRenderer --state <file> --output <directory>
+                                   [--threads <n>] [--block <samples>] [--double]
+                                   <file or directory>...
+
+    The state is a blob saved by the plugin (getStateInformation).
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "AllocationTripwire.h"
+
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    //==============================================================================
+    struct Options
+    {
+        juce::File stateFile, outputDirectory;
+        juce::Array<juce::File> inputs;
+        int numThreads{ juce::SystemStats::getNumCpus() };
+        int blockSize{ 8192 };
+        bool doublePrecision{ false };
+    };
+
+    struct Job
+    {
+        juce::File input, output;
+        juce::int64 size{ 0 };
+    };
+
+    struct JobResult
+    {
+        double audioSeconds{ 0.0 }, wallSeconds{ 0.0 };
+        juce::String error;
+    };
+
+    constexpr const char* audioFilePatterns = "*.wav;*.aif;*.aiff";
+
+    void printUsage()
+    {
+        std::cerr << "Usage: FeatheringBatchRenderer --state <file> --output <directory>\n"
+                     "                               [--threads <n>] [--block <samples>] [--double]\n"
+                     "                               <file or directory>..." << std::endl;
+    }
+
+    std::optional<Options> parseOptions(const juce::StringArray& args)
+    {
+        Options options;
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            auto hasValue = i + 1 < args.size();
+
+            if (arg == "--state" && hasValue)
+                options.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+            else if (arg == "--output" && hasValue)
+                options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+            else if (arg == "--threads" && hasValue)
+                options.numThreads = args[++i].getIntValue();
+            else if (arg == "--block" && hasValue)
+                options.blockSize = args[++i].getIntValue();
+            else if (arg == "--double")
+                options.doublePrecision = true;
+            else if (arg.startsWith("--"))
+                return {};
+            else
+                options.inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+        }
+
+        if (options.stateFile == juce::File() || options.outputDirectory == juce::File() || options.inputs.isEmpty()
+             || options.numThreads < 1 || options.blockSize < 1)
+            return {};
+
+        return options;
+    }
+
+    // Every audio file under the inputs, each with where it will be written, largest first
+    std::vector<Job> findJobs(const Options& options)
+    {
+        std::vector<Job> jobs;
+
+        auto addJob = [&](const juce::File& input, const juce::String& relativePath)
+        {
+            auto output = options.outputDirectory.getChildFile(relativePath);
+
+            if (output == input)
+            {
+                std::cerr << "Skipping " << input.getFullPathName() << ": it would be overwritten" << std::endl;
+                return;
+            }
+
+            jobs.push_back({ input, output, input.getSize() });
+        };
+
+        for (const auto& input : options.inputs)
+        {
+            if (input.isDirectory())
+            {
+                for (const auto& entry : juce::RangedDirectoryIterator(input, true, audioFilePatterns, juce::File::findFiles))
+                    addJob(entry.getFile(), entry.getFile().getRelativePathFrom(input));
+            }
+            else if (input.existsAsFile())
+            {
+                addJob(input, input.getFileName());
+            }
+            else
+            {
+                std::cerr << "Not found: " << input.getFullPathName() << std::endl;
+            }
+        }
+
+        std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.size > b.size; });
+        return jobs;
+    }
+
+    //==============================================================================
+    // One processor and one set of buffers, reused for every file the worker renders
+    class Worker
+    {
+    public:
+        Worker(const juce::MemoryBlock& state, const Options& optionsToUse)
+            : options(optionsToUse)
+        {
+            formatManager.registerBasicFormats();
+
+            processor.setNonRealtime(true);
+            processor.setProcessingPrecision(options.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                     : juce::AudioProcessor::singlePrecision);
+            processor.setStateInformation(state.getData(), (int) state.getSize());
+        }
+
+        JobResult render(const Job& job)
+        {
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            JobResult result;
+
+            result.error = renderFile(job, result.audioSeconds);
+            result.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+            return result;
+        }
+
+        double getBusySeconds() const noexcept  { return busySeconds; }
+
+        void addBusySeconds(double seconds) noexcept  { busySeconds += seconds; }
+
+    private:
+        juce::String renderFile(const Job& job, double& audioSeconds)
+        {
+            auto* format = formatManager.findFormatForFileExtension(job.input.getFileExtension());
+
+            if (format == nullptr)
+                return "unknown format";
+
+            // Mapped readers page the file in as it's read; fall back to streaming for anything else
+            std::unique_ptr<juce::AudioFormatReader> reader;
+
+            if (std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped { format->createMemoryMappedReader(job.input) };
+                mapped != nullptr && mapped->mapEntireFile())
+                reader = std::move(mapped);
+            else
+                reader.reset(formatManager.createReaderFor(job.input));
+
+            if (reader == nullptr)
+                return "can't read the file";
+
+            auto numChannels = (int) reader->numChannels;
+
+            if (! prepare(numChannels, reader->sampleRate))
+                return "unsupported channel count " + juce::String(numChannels);
+
+            // Written next to the target and moved over it once complete, so a failed render leaves nothing half-written
+            if (! job.output.getParentDirectory().createDirectory())
+                return "can't create " + job.output.getParentDirectory().getFullPathName();
+
+            juce::TemporaryFile temporary(job.output);
+            auto stream = std::make_unique<juce::FileOutputStream>(temporary.getFile(), outputBufferSize);
+
+            if (stream->failedToOpen())
+                return "can't write " + temporary.getFile().getFullPathName();
+
+            std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader->sampleRate, (unsigned int) numChannels,
+                                                                                    (int) reader->bitsPerSample, reader->metadataValues, 0));
+
+            if (writer == nullptr)
+                return "can't write " + juce::String(reader->bitsPerSample) + "-bit " + format->getFormatName();
+
+            stream.release();
+
+            auto ok = options.doublePrecision ? renderSamples<double>(*reader, *writer)
+                                              : renderSamples<float>(*reader, *writer);
+
+            writer.reset();
+
+            if (! ok)
+                return "read or write failed";
+
+            if (! temporary.overwriteTargetFileWithTemporary())
+                return "can't replace " + job.output.getFullPathName();
+
+            audioSeconds = (double) reader->lengthInSamples / reader->sampleRate;
+            return {};
+        }
+
+        // Re-prepares the processor only when the channel count or sample rate changes, and clears it for the next file
+        bool prepare(int numChannels, double sampleRate)
+        {
+            if (numChannels != preparedChannels || sampleRate != preparedSampleRate)
+            {
+                auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+                juce::AudioProcessor::BusesLayout layout;
+                layout.inputBuses.add(channelSet);
+                layout.outputBuses.add(channelSet);
+
+                if (channelSet.isDisabled() || ! processor.setBusesLayout(layout))
+                    return false;
+
+                processor.setRateAndBufferSizeDetails(sampleRate, options.blockSize);
+                processor.prepareToPlay(sampleRate, options.blockSize);
+
+                floatBuffer.setSize(numChannels, options.blockSize);
+                doubleBuffer.setSize(numChannels, options.blockSize);
+
+                preparedChannels = numChannels;
+                preparedSampleRate = sampleRate;
+
+                waitForKernel();
+            }
+
+            processor.reset();
+            return true;
+        }
+
+        // Runs quiet noise through until the linear-phase kernel is in and its crossfade from the
+        // old one is over. Noise rather than silence, or the silence gate would stop the processing
+        // that swaps the kernel in.
+        void waitForKernel()
+        {
+            constexpr double timeoutMs = 10000.0, crossfadeSeconds = 0.1;
+            constexpr float noiseLevel = 1.0e-4f;
+
+            juce::Random random;
+            juce::MidiBuffer midi;
+
+            auto deadline = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+            auto crossfadeSamples = juce::roundToInt(crossfadeSeconds * preparedSampleRate);
+
+            auto processNoise = [&]
+            {
+                for (int channel = 0; channel < floatBuffer.getNumChannels(); ++channel)
+                    for (int i = 0; i < floatBuffer.getNumSamples(); ++i)
+                        floatBuffer.setSample(channel, i, noiseLevel * (2.f * random.nextFloat() - 1.f));
+
+                processBuffer(floatBuffer.getNumSamples(), midi);
+            };
+
+            auto waited = false;
+
+            while (processor.isWaitingForKernel())
+            {
+                waited = true;
+
+                if (juce::Time::getMillisecondCounterHiRes() > deadline)
+                {
+                    std::cerr << "Timed out waiting for the linear-phase kernel" << std::endl;
+                    return;
+                }
+
+                processNoise();
+                juce::Thread::sleep(5);
+            }
+
+            if (waited)
+                for (int done = 0; done < crossfadeSamples; done += floatBuffer.getNumSamples())
+                    processNoise();
+        }
+
+        // Processes the first numSamples of floatBuffer, through doubleBuffer in double precision
+        void processBuffer(int numSamples, juce::MidiBuffer& midi)
+        {
+            if (! options.doublePrecision)
+            {
+                juce::AudioBuffer<float> block(floatBuffer.getArrayOfWritePointers(), floatBuffer.getNumChannels(), numSamples);
+                processor.processBlock(block, midi);
+                return;
+            }
+
+            juce::AudioBuffer<double> block(doubleBuffer.getArrayOfWritePointers(), doubleBuffer.getNumChannels(), numSamples);
+
+            for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                auto* source = floatBuffer.getReadPointer(channel);
+                auto* destination = block.getWritePointer(channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    destination[i] = (double) source[i];
+            }
+
+            processor.processBlock(block, midi);
+
+            for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                auto* source = block.getReadPointer(channel);
+                auto* destination = floatBuffer.getWritePointer(channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    destination[i] = (float) source[i];
+            }
+        }
+
+        // Readers and writers deal in float, so a double render converts on the way through
+        template <typename SampleType>
+        bool renderSamples(juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer)
+        {
+            juce::MidiBuffer midi;
+
+            auto latency = (juce::int64) processor.getLatencySamples();
+            auto inputLength = reader.lengthInSamples;
+            auto totalLength = inputLength + latency;
+
+            for (juce::int64 position = 0; position < totalLength; position += options.blockSize)
+            {
+                auto numSamples = (int) juce::jmin((juce::int64) options.blockSize, totalLength - position);
+                auto numToRead = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, inputLength - position);
+
+                if (numToRead > 0 && ! reader.read(&floatBuffer, 0, numToRead, position, true, true))
+                    return false;
+
+                // Past the end of the input, zeros push the delayed output out
+                if (numToRead < numSamples)
+                    floatBuffer.clear(numToRead, numSamples - numToRead);
+
+                processBuffer(numSamples, midi);
+
+                auto numToSkip = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, latency - position);
+
+                if (numToSkip < numSamples && ! writer.writeFromAudioSampleBuffer(floatBuffer, numToSkip, numSamples - numToSkip))
+                    return false;
+            }
+
+            return true;
+        }
+
+        static constexpr size_t outputBufferSize = 1 << 20;
+
+        const Options& options;
+        FeatheringIdeaStartAudioProcessor processor;
+        juce::AudioFormatManager formatManager;
+
+        juce::AudioBuffer<float> floatBuffer;
+        juce::AudioBuffer<double> doubleBuffer;
+        int preparedChannels{ 0 };
+        double preparedSampleRate{ 0.0 };
+        double busySeconds{ 0.0 };
+    };
+
+    //==============================================================================
+    void printResult(const Job& job, const JobResult& result)
+    {
+        if (result.error.isNotEmpty())
+        {
+            std::cerr << "FAILED " << job.input.getFullPathName() << ": " << result.error << std::endl;
+            return;
+        }
+
+        std::cout << juce::String(result.audioSeconds, 1).paddedLeft(' ', 9) << " s audio"
+                  << juce::String(result.wallSeconds, 2).paddedLeft(' ', 9) << " s"
+                  << juce::String(result.audioSeconds / juce::jmax(result.wallSeconds, 1.0e-9), 1).paddedLeft(' ', 9) << "x   "
+                  << job.input.getFileName() << std::endl;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    // A stray allocation costs an offline render nothing, so don't stop for one
+    AllocationTripwire::setAssertOnAllocation(false);
+
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto options = parseOptions(args);
+
+    if (! options.has_value())
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::MemoryBlock state;
+
+    if (! options->stateFile.loadFileAsData(state) || state.isEmpty())
+    {
+        std::cerr << "Can't read the state from " << options->stateFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto jobs = findJobs(*options);
+
+    if (jobs.empty())
+    {
+        std::cerr << "No audio files to render" << std::endl;
+        return 1;
+    }
+
+    auto numWorkers = juce::jmin(options->numThreads, (int) jobs.size());
+
+    // Processors are created and given their state here, on the message thread; only the rendering runs on the workers
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<Worker>(state, *options));
+
+    std::vector<JobResult> results(jobs.size());
+    std::atomic<size_t> nextJob{ 0 };
+    std::mutex outputMutex;
+
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        std::vector<std::thread> threads;
+
+        for (auto& worker : workers)
+        {
+            threads.emplace_back([&, workerToUse = worker.get()]
+            {
+                for (auto index = nextJob++; index < jobs.size(); index = nextJob++)
+                {
+                    results[index] = workerToUse->render(jobs[index]);
+                    workerToUse->addBusySeconds(results[index].wallSeconds);
+
+                    const std::lock_guard<std::mutex> lock(outputMutex);
+                    printResult(jobs[index], results[index]);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    double audioSeconds = 0.0, busySeconds = 0.0;
+    int numFailed = 0;
+
+    for (const auto& result : results)
+    {
+        audioSeconds += result.audioSeconds;
+        numFailed += result.error.isNotEmpty() ? 1 : 0;
+    }
+
+    for (const auto& worker : workers)
+        busySeconds += worker->getBusySeconds();
+
+    // Busy below 100% means workers sat idle at the end waiting for the last files
+    std::cout << "\n" << (int) jobs.size() - numFailed << " of " << (int) jobs.size() << " files, "
+              << juce::String(audioSeconds, 1) << " s of audio in " << juce::String(wallSeconds, 2) << " s on "
+              << numWorkers << " threads\n"
+              << "  " << juce::String(audioSeconds / juce::jmax(wallSeconds, 1.0e-9), 1) << "x real time, "
+              << juce::String(audioSeconds / juce::jmax(busySeconds, 1.0e-9), 1) << "x per thread, "
+              << juce::String(100.0 * busySeconds / juce::jmax(wallSeconds * numWorkers, 1.0e-9), 1) << "% busy" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,1476 @@
+/*
+  ==============================================================================
+
+    BenchmarkMain.cpp
+
+    Headless benchmark for the DSP core. Drives the plugin processor with no
+    GUI, and the band engine directly for band counts other than the one the
+    processor was compiled with. Each sweep varies one thing from a baseline
+    of 48 kHz, 512-sample blocks, stereo and static parameters:
+
+      block size, sample rate, channel count, automation density,
+      processing engine, oversampling factor, band count and SIMD kernel,
+      control interval, float against double precision, and silent input
+
+    Every run reports, per channel sample, the wall time in ns and the
+    reference cycles from the x86 time-stamp counter, then the number of
+    heap allocations made on the audio thread and the worst block's time,
+    also as a fraction of that block's real-time duration.
+
+    The snapshot morph sweep reports what moving the morph costs per block,
+    and the cascade's cost while gliding and while jumping (crossfading)
+    between snapshots.
+
+    A state sweep measures saving and restoring state at several band
+    counts: blob size and time per call for the binary format, against the
+    APVTS XML it replaced, and what restoring 500 instances would cost.
+
+    A precision sweep measures the noise floor of float and double engines
+    where float suffers most: narrow bands in the bottom octave at high
+    sample rates. Each runs noise through the cascade, and the error
+    against the same recurrence in long double, coefficients included, is
+    reported relative to the output level.
+
+    The last sweep compares coefficient designers: coefficients computed
+    per microsecond, and the worst magnitude response error against
+    makePeakSVF() (bells) or the exact tier (shelves), over a grid of
+    frequencies, Qs and gains. Before it, each FastDesign tier's prewarp
+    and dB-to-amplitude conversion is measured over the range FastDesign.h
+    documents, and if any tier is outside its bounds the benchmark says so
+    and exits with 1.
+
+    Usage: FeatheringBenchmark [--quick] [--csv]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "AllocationTripwire.h"
+#include "StateSerializer.h"
+#include "SnapshotBank.h"
+#include "FastDesign.h"
+
+#include <chrono>
+#include <complex>
+
+#if defined (_MSC_VER) && (defined (_M_X64) || defined (_M_IX86))
+ #include <intrin.h>
+ #define FEATHERING_HAS_TSC 1
+#elif defined (__x86_64__) || defined (__i386__)
+ #include <x86intrin.h>
+ #define FEATHERING_HAS_TSC 1
+#else
+ #define FEATHERING_HAS_TSC 0
+#endif
+
+namespace
+{
+    //==============================================================================
+    juce::uint64 readTimeStampCounter() noexcept
+    {
+       #if FEATHERING_HAS_TSC
+        return (juce::uint64) __rdtsc();
+       #else
+        return 0;
+       #endif
+    }
+
+    enum class Automation
+    {
+        none,
+        perBlock,
+        perSample
+    };
+
+    const char* getAutomationName(Automation automation)
+    {
+        switch (automation)
+        {
+            case Automation::perBlock:  return "per-block";
+            case Automation::perSample: return "per-sample";
+            case Automation::none:
+            default:                    return "static";
+        }
+    }
+
+    struct RunConfig
+    {
+        juce::String engine{ "IIR" };
+        double sampleRate{ 48000.0 };
+        int blockSize{ 512 };
+        int numChannels{ 2 };
+        int numBands{ FeatheringIdeaStartAudioProcessor::numBands };
+        Automation automation{ Automation::none };
+        bool dynamicBands{ false };     // engine runs only: every band follows the level above -40 dB at 4:1
+        int channelMode{ FeatherParameters::linked };   // engine runs only: bands are placed All, Left / Mid, Right / Side in turn
+        bool doublePrecision{ false };
+        bool silentInput{ false };      // processor runs only: digital silence, so the filters go idle after their tail
+        int cutSlope{ FeatherParameters::cutOff };     // engine runs only: a low cut at 80 Hz and a high cut at 12 kHz
+    };
+
+    // The speaker layout a host would most likely offer for a channel count
+    juce::AudioChannelSet getBenchmarkLayout(int numChannels)
+    {
+        return numChannels == 12 ? juce::AudioChannelSet::create7point1point4()
+                                 : juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    }
+
+    // Counts heap allocations made on this thread while in scope. The tools build enables the
+    // tripwire, and only the benchmark's own thread counts, so background kernel builds don't show up.
+    class AllocationCount
+    {
+    public:
+        juce::int64 get() const noexcept
+        {
+            return AllocationTripwire::getNumRealtimeAllocationsOnThisThread() - startCount;
+        }
+
+    private:
+        AllocationTripwire::ScopedRealtimeSection realtimeSection;
+        juce::int64 startCount{ AllocationTripwire::getNumRealtimeAllocationsOnThisThread() };
+    };
+
+    struct RunResult
+    {
+        double nsPerSample{ 0.0 }, cyclesPerSample{ 0.0 };
+        double worstBlockMicroseconds{ 0.0 }, worstBlockLoad{ 0.0 };
+        juce::int64 numAllocations{ 0 };
+    };
+
+    // Accumulates per-block timings into a RunResult
+    class RunTimer
+    {
+    public:
+        explicit RunTimer(const RunConfig& c) : config(c) {}
+
+        template <typename Function>
+        void timeBlock(int numSamples, Function&& processBlock)
+        {
+            auto startCycles = readTimeStampCounter();
+            auto start = std::chrono::steady_clock::now();
+
+            processBlock();
+
+            auto elapsedNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            totalCycles += readTimeStampCounter() - startCycles;
+            totalNs += elapsedNs;
+            totalSamples += numSamples;
+
+            worstNs = juce::jmax(worstNs, elapsedNs);
+            worstLoad = juce::jmax(worstLoad, elapsedNs * 1.0e-9 * config.sampleRate / numSamples);
+        }
+
+        RunResult getResult(juce::int64 numAllocations) const
+        {
+            auto channelSamples = (double) totalSamples * config.numChannels;
+
+            RunResult result;
+            result.nsPerSample = totalNs / channelSamples;
+            result.cyclesPerSample = FEATHERING_HAS_TSC ? (double) totalCycles / channelSamples : 0.0;
+            result.worstBlockMicroseconds = worstNs * 1.0e-3;
+            result.worstBlockLoad = worstLoad;
+            result.numAllocations = numAllocations;
+            return result;
+        }
+
+    private:
+        const RunConfig& config;
+        double totalNs{ 0.0 }, worstNs{ 0.0 }, worstLoad{ 0.0 };
+        juce::uint64 totalCycles{ 0 };
+        juce::int64 totalSamples{ 0 };
+    };
+
+    //==============================================================================
+    // Gains chosen so every band is active, since bands at 0 dB are skipped
+    float getBenchmarkGain(int band)
+    {
+        static constexpr float gains[] = { 6.f, -4.5f, 3.f, -6.f, 4.5f, -3.f };
+        return gains[band % (int) std::size(gains)];
+    }
+
+    float getBenchmarkFreq(int band, int numBands)
+    {
+        // Spread log-evenly from 60 Hz to 12 kHz
+        return 60.f * std::pow(200.f, (float) band / (float) juce::jmax(1, numBands - 1));
+    }
+
+    // One cycle of a slow frequency sweep, looked up rather than computed so the
+    // automation itself costs next to nothing inside the timed region
+    const std::array<float, 256>& getAutomationTable()
+    {
+        static const auto table = []
+        {
+            std::array<float, 256> values{};
+
+            for (size_t i = 0; i < values.size(); ++i)
+                values[i] = 1000.f * std::pow(2.f, 2.f * std::sin(juce::MathConstants<float>::twoPi * (float) i / (float) values.size()));
+
+            return values;
+        }();
+
+        return table;
+    }
+
+    template <typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random(1);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, (SampleType) (random.nextFloat() * 0.5f - 0.25f));
+    }
+
+    int getNumBlocks(const RunConfig& config, double secondsOfAudio)
+    {
+        return juce::jmax(8, (int) std::ceil(secondsOfAudio * config.sampleRate / config.blockSize));
+    }
+
+    //==============================================================================
+    void setParameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& id, float value)
+    {
+        auto* parameter = apvts.getParameter(id);
+        jassert(parameter != nullptr);
+
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Engine names: "IIR", "IIR 2x" ... "IIR 8x" (polyphase IIR oversampling), "IIR 4x FIR"
+    // (FIR oversampling), "Linear 1024" ... "Linear 16384"
+    void configureEngine(juce::AudioProcessorValueTreeState& apvts, const juce::String& engine)
+    {
+        auto tokens = juce::StringArray::fromTokens(engine, false);
+
+        if (tokens[0] == "Linear")
+        {
+            setParameter(apvts, FeatherParameters::phaseModeID, (float) FeatherParameters::linearPhase);
+
+            auto length = tokens[1].getIntValue();
+            auto index = std::find(LinearPhaseEngine::kernelLengths.begin(), LinearPhaseEngine::kernelLengths.end(), length)
+                         - LinearPhaseEngine::kernelLengths.begin();
+
+            setParameter(apvts, FeatherParameters::kernelLengthID, (float) index);
+            return;
+        }
+
+        setParameter(apvts, FeatherParameters::phaseModeID, (float) FeatherParameters::minimumPhase);
+
+        auto factor = tokens[1].getIntValue();
+        setParameter(apvts, FeatherParameters::oversamplingID, factor > 1 ? (float) std::log2(factor) : 0.f);
+        setParameter(apvts, FeatherParameters::oversamplingFilterID,
+                     (float) (tokens[2] == "FIR" ? OversamplingStage::linearPhaseFIR : OversamplingStage::polyphaseIIR));
+    }
+
+    template <typename SampleType>
+    RunResult runProcessor(const RunConfig& config, double secondsOfAudio)
+    {
+        constexpr int numBands = FeatheringIdeaStartAudioProcessor::numBands;
+
+        FeatheringIdeaStartAudioProcessor processor;
+        auto& apvts = processor.apvts;
+
+        auto channelSet = getBenchmarkLayout(config.numChannels);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(channelSet);
+        layout.outputBuses.add(channelSet);
+
+        if (! processor.setBusesLayout(layout))
+        {
+            std::cerr << "Unsupported channel count: " << config.numChannels << std::endl;
+            return {};
+        }
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            setParameter(apvts, FeatherParameters::getFreqID(band), getBenchmarkFreq(band, numBands));
+            setParameter(apvts, FeatherParameters::getGainID(band), getBenchmarkGain(band));
+            setParameter(apvts, FeatherParameters::getQualityID(band), 1.5f);
+        }
+
+        configureEngine(apvts, config.engine);
+
+        processor.setProcessingPrecision(std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                              : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+        processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+        juce::AudioBuffer<SampleType> source(config.numChannels, config.blockSize), buffer(config.numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+
+        if (config.silentInput)
+            source.clear();
+        else
+            fillWithNoise(source);
+
+        auto* freqParameter = apvts.getParameter(FeatherParameters::getFreqID(0));
+        const auto& automationValues = getAutomationTable();
+        size_t automationIndex = 0;
+
+        auto automate = [&]
+        {
+            freqParameter->setValueNotifyingHost(freqParameter->convertTo0to1(automationValues[automationIndex]));
+            automationIndex = (automationIndex + 1) % automationValues.size();
+        };
+
+        auto processOneBlock = [&]
+        {
+            if (config.automation == Automation::perBlock)
+                automate();
+
+            if (config.automation != Automation::perSample)
+            {
+                processor.processBlock(buffer, midi);
+                return;
+            }
+
+            // Sample-accurate automation as a host delivers it: the block split at every change
+            for (int i = 0; i < config.blockSize; ++i)
+            {
+                automate();
+
+                juce::AudioBuffer<SampleType> sample(buffer.getArrayOfWritePointers(), config.numChannels, i, 1);
+                processor.processBlock(sample, midi);
+            }
+        };
+
+        // Warm up, and give the background thread time to deliver a linear-phase kernel
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (int block = 0; block < 4; ++block)
+            {
+                buffer.makeCopyOf(source, true);
+                processOneBlock();
+            }
+
+            if (config.engine.startsWith("Linear"))
+                juce::Thread::sleep(300);
+        }
+
+        RunTimer timer(config);
+        juce::int64 numAllocations = 0;
+
+        for (int block = getNumBlocks(config, secondsOfAudio); --block >= 0;)
+        {
+            buffer.makeCopyOf(source, true);
+
+            AllocationCount allocations;
+            timer.timeBlock(config.blockSize, processOneBlock);
+            numAllocations += allocations.get();
+        }
+
+        processor.releaseResources();
+        return timer.getResult(numAllocations);
+    }
+
+    RunResult runProcessor(const RunConfig& config, double secondsOfAudio)
+    {
+        return config.doublePrecision ? runProcessor<double>(config, secondsOfAudio)
+                                      : runProcessor<float>(config, secondsOfAudio);
+    }
+
+    //==============================================================================
+    // Runs the band engine directly, so band counts other than the compiled one can be measured
+    template <int NumBands, typename SampleType>
+    RunResult runEngine(const RunConfig& config, double secondsOfAudio,
+                        std::optional<Cascade::KernelType> kernelType, int controlInterval)
+    {
+        FeatherEngine<NumBands, SampleType> engine;
+
+        auto makeBand = [&config](int band, float freq) -> BandSettings
+        {
+            BandSettings settings{ freq, getBenchmarkGain(band), 1.5f };
+
+            if (config.dynamicBands)
+            {
+                settings.thresholdInDecibels = -40.f;
+                settings.ratio = 4.f;
+            }
+
+            if (config.channelMode != FeatherParameters::linked)
+                settings.placement = band % 3;
+
+            return settings;
+        };
+
+        for (int band = 0; band < NumBands; ++band)
+            engine.setBandTarget(band, makeBand(band, getBenchmarkFreq(band, NumBands)));
+
+        engine.setCutTarget(FeatherParameters::lowCut, { 80.f, config.cutSlope });
+        engine.setCutTarget(FeatherParameters::highCut, { 12000.f, config.cutSlope });
+
+        engine.setChannelRoles(ChannelRoles::fromChannelSet(getBenchmarkLayout(config.numChannels)));
+        engine.setChannelMode(config.channelMode);
+
+        if (kernelType.has_value())
+            engine.setKernelType(*kernelType);
+
+        engine.setControlInterval(controlInterval);
+        engine.prepare({ config.sampleRate, (juce::uint32) config.blockSize, (juce::uint32) config.numChannels });
+
+        juce::AudioBuffer<SampleType> source(config.numChannels, config.blockSize), buffer(config.numChannels, config.blockSize);
+        fillWithNoise(source);
+
+        const auto& automationValues = getAutomationTable();
+        size_t automationIndex = 0;
+
+        auto automate = [&]
+        {
+            engine.setBandTarget(0, makeBand(0, automationValues[automationIndex]));
+            automationIndex = (automationIndex + 1) % automationValues.size();
+        };
+
+        auto processOneBlock = [&]
+        {
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+
+            if (config.automation == Automation::perBlock)
+                automate();
+
+            if (config.automation != Automation::perSample)
+            {
+                engine.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+                return;
+            }
+
+            for (size_t i = 0; i < (size_t) config.blockSize; ++i)
+            {
+                automate();
+
+                auto sample = block.getSubBlock(i, 1);
+                engine.process(juce::dsp::ProcessContextReplacing<SampleType>(sample));
+            }
+        };
+
+        for (int block = 0; block < 4; ++block)
+        {
+            buffer.makeCopyOf(source, true);
+            processOneBlock();
+        }
+
+        RunTimer timer(config);
+        juce::int64 numAllocations = 0;
+
+        for (int block = getNumBlocks(config, secondsOfAudio); --block >= 0;)
+        {
+            buffer.makeCopyOf(source, true);
+
+            AllocationCount allocations;
+            timer.timeBlock(config.blockSize, processOneBlock);
+            numAllocations += allocations.get();
+        }
+
+        return timer.getResult(numAllocations);
+    }
+
+    template <typename SampleType>
+    RunResult runEngineInPrecision(const RunConfig& config, double secondsOfAudio,
+                                   std::optional<Cascade::KernelType> kernelType, int controlInterval)
+    {
+        switch (config.numBands)
+        {
+            case 1:  return runEngine<1, SampleType>(config, secondsOfAudio, kernelType, controlInterval);
+            case 4:  return runEngine<4, SampleType>(config, secondsOfAudio, kernelType, controlInterval);
+            case 8:  return runEngine<8, SampleType>(config, secondsOfAudio, kernelType, controlInterval);
+            case 16: return runEngine<16, SampleType>(config, secondsOfAudio, kernelType, controlInterval);
+            case 32: return runEngine<32, SampleType>(config, secondsOfAudio, kernelType, controlInterval);
+            case 64: return runEngine<64, SampleType>(config, secondsOfAudio, kernelType, controlInterval);
+            default: jassertfalse; return {};
+        }
+    }
+
+    RunResult runEngine(const RunConfig& config, double secondsOfAudio,
+                        std::optional<Cascade::KernelType> kernelType = {},
+                        int controlInterval = FeatherEngine<1>::defaultControlInterval)
+    {
+        return config.doublePrecision ? runEngineInPrecision<double>(config, secondsOfAudio, kernelType, controlInterval)
+                                      : runEngineInPrecision<float>(config, secondsOfAudio, kernelType, controlInterval);
+    }
+
+    //==============================================================================
+    // Narrow bands crowded into the bottom octave, alternately boosting and cutting: small g and
+    // high Q are where float's rounding of the states and coefficients shows up first
+    constexpr int numNoiseFloorBands = 8;
+
+    BandSettings getNoiseFloorBand(int band)
+    {
+        auto freq = 20.f * std::pow(2.f, (float) band / (float) (numNoiseFloorBands - 1));
+        return { freq, band % 2 == 0 ? 12.f : -12.f, 10.f };
+    }
+
+    // The engine's output against the same cascade in long double, relative to the output level.
+    // Compilers where long double is double measure the double engine against itself.
+    template <typename SampleType>
+    double measureNoiseFloorDecibels(double sampleRate, double secondsOfAudio)
+    {
+        constexpr int blockSize = 512;
+
+        FeatherEngine<numNoiseFloorBands, SampleType> engine;
+
+        for (int band = 0; band < numNoiseFloorBands; ++band)
+            engine.setBandTarget(band, getNoiseFloorBand(band));
+
+        engine.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+
+        struct ReferenceSection
+        {
+            long double a1, a2, a3, m0, m1, m2;
+            long double ic1eq{ 0 }, ic2eq{ 0 };
+        };
+
+        std::array<ReferenceSection, (size_t) numNoiseFloorBands> reference;
+
+        for (int band = 0; band < numNoiseFloorBands; ++band)
+        {
+            auto settings = getNoiseFloorBand(band);
+            auto c = makePeakSVF<double>(sampleRate, settings.freq, settings.quality, settings.gainInDecibels);
+            reference[(size_t) band] = { c.a1, c.a2, c.a3, c.m0, c.m1, c.m2 };
+        }
+
+        juce::AudioBuffer<SampleType> buffer(1, blockSize);
+        juce::Random random(1);
+        long double signalEnergy = 0, errorEnergy = 0;
+
+        // The first second lets the narrow bands ring up before anything is measured
+        auto numWarmUpBlocks = (int) std::ceil(sampleRate / blockSize);
+        auto numBlocks = numWarmUpBlocks + juce::jmax(8, (int) std::ceil(secondsOfAudio * sampleRate / blockSize));
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            auto* samples = buffer.getWritePointer(0);
+            std::array<long double, (size_t) blockSize> expected;
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                auto input = (SampleType) (random.nextFloat() * 0.5f - 0.25f);
+                samples[i] = input;
+
+                long double v0 = input;
+
+                for (auto& s : reference)
+                {
+                    auto v3 = v0 - s.ic2eq;
+                    auto v1 = s.a1 * s.ic1eq + s.a2 * v3;
+                    auto v2 = s.ic2eq + s.a2 * s.ic1eq + s.a3 * v3;
+
+                    s.ic1eq = 2 * v1 - s.ic1eq;
+                    s.ic2eq = 2 * v2 - s.ic2eq;
+                    v0 = s.m0 * v0 + s.m1 * v1 + s.m2 * v2;
+                }
+
+                expected[(size_t) i] = v0;
+            }
+
+            juce::dsp::AudioBlock<SampleType> audioBlock(buffer);
+            engine.process(juce::dsp::ProcessContextReplacing<SampleType>(audioBlock));
+
+            if (block < numWarmUpBlocks)
+                continue;
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                auto error = (long double) samples[i] - expected[(size_t) i];
+                signalEnergy += expected[(size_t) i] * expected[(size_t) i];
+                errorEnergy += error * error;
+            }
+        }
+
+        return 10.0 * std::log10((double) (errorEnergy / signalEnergy) + 1.0e-300);
+    }
+
+    //==============================================================================
+    template <typename Function>
+    double getMicrosecondsPerCall(int numCalls, Function&& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < numCalls; ++i)
+            function(i);
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return (double) elapsed.count() * 1.0e-3 / numCalls;
+    }
+
+    struct MorphResult
+    {
+        double updateNsPerBlock{ 0.0 };
+        RunResult glide, jumps;
+    };
+
+    // Drives a CrossfadingEngine from a SnapshotBank, the way the processor does while morphing
+    template <int NumBands>
+    MorphResult runMorph(const RunConfig& config, double secondsOfAudio)
+    {
+        SnapshotBank<NumBands> snapshots;
+
+        for (int snapshot = 0; snapshot < SnapshotBank<NumBands>::numSnapshots; ++snapshot)
+        {
+            ChainSettings<NumBands> settings;
+
+            for (int band = 0; band < NumBands; ++band)
+                settings.bands[(size_t) band] = { getBenchmarkFreq(band, NumBands) * std::exp2((float) snapshot - 1.5f),
+                                                  getBenchmarkGain(band + snapshot), 0.7f + (float) snapshot };
+
+            snapshots.store(snapshot, settings);
+        }
+
+        snapshots.publish();
+
+        constexpr auto lastPosition = (float) (SnapshotBank<NumBands>::numSnapshots - 1);
+
+        CrossfadingEngine<NumBands> engine;
+        snapshots.updateMorph(0.f, engine);
+        engine.prepare({ config.sampleRate, (juce::uint32) config.blockSize, (juce::uint32) config.numChannels });
+
+        MorphResult result;
+
+        // The update alone: every block's position differs, so every band is sent
+        constexpr int numUpdates = 10000;
+
+        result.updateNsPerBlock = getMicrosecondsPerCall(numUpdates, [&](int i)
+        {
+            snapshots.updateMorph(lastPosition * (float) (i % 1000) / 1000.f, engine);
+        }) * 1.0e3;
+
+        juce::AudioBuffer<float> source(config.numChannels, config.blockSize), buffer(config.numChannels, config.blockSize);
+        fillWithNoise(source);
+
+        auto numBlocks = getNumBlocks(config, secondsOfAudio);
+
+        // Gliding sweeps through every snapshot and back; jumping hops between the ends every 100 ms
+        auto run = [&](bool jump)
+        {
+            auto blocksPerJump = juce::jmax(1, juce::roundToInt(0.1 * config.sampleRate / config.blockSize));
+
+            engine.reset();
+            snapshots.updateMorph(0.f, engine);
+
+            RunTimer timer(config);
+            juce::int64 numAllocations = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                auto phase = (float) block / (float) numBlocks;
+                auto position = jump ? ((block / blocksPerJump) % 2 == 0 ? 0.f : lastPosition)
+                                     : lastPosition * (1.f - std::abs(2.f * phase - 1.f));
+
+                buffer.makeCopyOf(source, true);
+
+                AllocationCount allocations;
+
+                timer.timeBlock(config.blockSize, [&]
+                {
+                    juce::dsp::AudioBlock<float> audio(buffer);
+
+                    snapshots.updateMorph(position, engine);
+                    engine.process(juce::dsp::ProcessContextReplacing<float>(audio));
+                });
+
+                numAllocations += allocations.get();
+            }
+
+            return timer.getResult(numAllocations);
+        };
+
+        result.glide = run(false);
+        result.jumps = run(true);
+        return result;
+    }
+
+    MorphResult runMorph(const RunConfig& config, double secondsOfAudio)
+    {
+        switch (config.numBands)
+        {
+            case 4:  return runMorph<4>(config, secondsOfAudio);
+            case 16: return runMorph<16>(config, secondsOfAudio);
+            case 64: return runMorph<64>(config, secondsOfAudio);
+            default: jassertfalse; return {};
+        }
+    }
+
+    //==============================================================================
+    // A bare processor with just the band parameters, so state can be measured at band counts
+    // other than the plugin's
+    template <int NumBands>
+    class ParameterHost  : public juce::AudioProcessor
+    {
+    public:
+        ParameterHost() : AudioProcessor(BusesProperties()) {}
+
+        const juce::String getName() const override                     { return "Parameter host"; }
+        void prepareToPlay(double, int) override                        {}
+        void releaseResources() override                                {}
+        void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+        double getTailLengthSeconds() const override                    { return 0.0; }
+        bool acceptsMidi() const override                               { return false; }
+        bool producesMidi() const override                              { return false; }
+        juce::AudioProcessorEditor* createEditor() override             { return nullptr; }
+        bool hasEditor() const override                                 { return false; }
+        int getNumPrograms() override                                   { return 1; }
+        int getCurrentProgram() override                                { return 0; }
+        void setCurrentProgram(int) override                            {}
+        const juce::String getProgramName(int) override                 { return {}; }
+        void changeProgramName(int, const juce::String&) override       {}
+        void getStateInformation(juce::MemoryBlock&) override           {}
+        void setStateInformation(const void*, int) override             {}
+
+        juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createLayout() };
+
+    private:
+        static juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
+        {
+            juce::AudioProcessorValueTreeState::ParameterLayout layout;
+            FeatherParameters::addBandParameters<NumBands>(layout);
+            return layout;
+        }
+    };
+
+    struct StateResult
+    {
+        size_t binaryBytes{ 0 }, xmlBytes{ 0 };
+        double binaryWriteUs{ 0.0 }, binaryReadUs{ 0.0 }, xmlWriteUs{ 0.0 }, xmlReadUs{ 0.0 };
+    };
+
+    template <int NumBands>
+    StateResult runState(int numCalls)
+    {
+        ParameterHost<NumBands> host;
+        auto& apvts = host.apvts;
+        StateSerializer serializer(apvts);
+
+        auto writeXml = [&apvts](juce::MemoryBlock& destination)
+        {
+            if (auto xml = apvts.copyState().createXml())
+                juce::AudioProcessor::copyXmlToBinary(*xml, destination);
+        };
+
+        // Two different states, restored alternately so every restore changes every band parameter
+        std::array<juce::MemoryBlock, 2> binaryStates, xmlStates;
+
+        for (size_t state = 0; state < 2; ++state)
+        {
+            for (int band = 0; band < NumBands; ++band)
+            {
+                setParameter(apvts, FeatherParameters::getFreqID(band), getBenchmarkFreq(band, NumBands) * (state == 0 ? 1.f : 1.5f));
+                setParameter(apvts, FeatherParameters::getGainID(band), getBenchmarkGain(band) * (state == 0 ? 1.f : -1.f));
+                setParameter(apvts, FeatherParameters::getQualityID(band), state == 0 ? 0.7f : 2.f);
+            }
+
+            serializer.write(binaryStates[state]);
+            writeXml(xmlStates[state]);
+        }
+
+        auto restore = [&serializer](const juce::MemoryBlock& state)
+        {
+            auto result = serializer.read(state.getData(), (int) state.getSize());
+            jassert(result != StateSerializer::Result::rejected);
+            juce::ignoreUnused(result);
+        };
+
+        juce::MemoryBlock scratch;
+
+        StateResult result;
+        result.binaryBytes = binaryStates[0].getSize();
+        result.xmlBytes = xmlStates[0].getSize();
+        result.binaryWriteUs = getMicrosecondsPerCall(numCalls, [&](int) { serializer.write(scratch); });
+        result.binaryReadUs = getMicrosecondsPerCall(numCalls, [&](int i) { restore(binaryStates[(size_t) (i % 2)]); });
+        result.xmlWriteUs = getMicrosecondsPerCall(numCalls, [&](int) { writeXml(scratch); });
+        result.xmlReadUs = getMicrosecondsPerCall(numCalls, [&](int i) { restore(xmlStates[(size_t) (i % 2)]); });
+        return result;
+    }
+
+    StateResult runState(int numBands, int numCalls)
+    {
+        switch (numBands)
+        {
+            case 4:   return runState<4>(numCalls);
+            case 16:  return runState<16>(numCalls);
+            case 64:  return runState<64>(numCalls);
+            case 256: return runState<256>(numCalls);
+            default:  jassertfalse; return {};
+        }
+    }
+
+    //==============================================================================
+    struct DesignCase
+    {
+        float normalisedFreq, quality, gainInDecibels;
+    };
+
+    struct DesignResult
+    {
+        double coefficientsPerMicrosecond{ 0.0 };
+        double maxPeakErrorDecibels{ 0.0 };
+        std::optional<double> maxShelfErrorDecibels;
+    };
+
+    // 20 Hz to 20 kHz at 48 kHz, across the plugin's Q range and both signs of gain
+    std::vector<DesignCase> getDesignCases()
+    {
+        std::vector<DesignCase> cases;
+
+        for (int i = 0; i < 40; ++i)
+            for (auto quality : { 0.1f, 0.7f, 2.f, 10.f })
+                for (auto gain : { -24.f, -12.f, -3.f, 3.f, 12.f, 24.f })
+                    cases.push_back({ 20.f * std::pow(1000.f, (float) i / 39.f) / 48000.f, quality, gain });
+
+        return cases;
+    }
+
+    // An SVF's magnitude at f / fs, recovering g and k from its coefficients
+    double getSVFMagnitude(const SVFCoefficients& c, double normalisedFreq)
+    {
+        auto g = (double) c.a2 / c.a1;
+        auto k = (1.0 / c.a1 - 1.0) / g - g;
+
+        std::complex<double> s(0.0, std::tan(juce::MathConstants<double>::pi * normalisedFreq) / g);
+        auto denominator = s * s + k * s + 1.0;
+
+        return std::abs((double) c.m0 + (double) c.m1 * s / denominator + (double) c.m2 / denominator);
+    }
+
+    template <typename Magnitude, typename Reference>
+    double getMaxResponseError(const std::vector<DesignCase>& cases, Magnitude&& getMagnitude, Reference&& getReference)
+    {
+        double maxError = 0.0;
+
+        for (const auto& designCase : cases)
+        {
+            for (int i = 0; i < 64; ++i)
+            {
+                auto probe = 10.0 * std::pow(2390.0, i / 63.0) / 48000.0;
+                auto error = juce::Decibels::gainToDecibels(getMagnitude(designCase, probe), -200.0)
+                           - juce::Decibels::gainToDecibels(getReference(designCase, probe), -200.0);
+
+                maxError = juce::jmax(maxError, std::abs(error));
+            }
+        }
+
+        return maxError;
+    }
+
+    // Designs every case numRepeats times; the sink keeps the work from being optimised away
+    template <typename Design>
+    double getCoefficientsPerMicrosecond(const std::vector<DesignCase>& cases, int numRepeats, Design&& design)
+    {
+        volatile float sink = 0.f;
+
+        auto microseconds = getMicrosecondsPerCall(numRepeats, [&](int) { sink = sink + design(); });
+        return (double) cases.size() / microseconds;
+    }
+
+    template <FastDesign::Accuracy accuracy>
+    DesignResult runFastDesign(const std::vector<DesignCase>& cases, int numRepeats, bool batched)
+    {
+        using FastDesign::Accuracy;
+
+        DesignResult result;
+
+        auto numCases = (int) cases.size();
+        std::vector<float> freqs, qualities, gains, g((size_t) numCases);
+        std::array<std::vector<float>, 6> columns;
+
+        for (const auto& designCase : cases)
+        {
+            freqs.push_back(designCase.normalisedFreq);
+            qualities.push_back(designCase.quality);
+            gains.push_back(designCase.gainInDecibels);
+        }
+
+        for (auto& column : columns)
+            column.resize((size_t) numCases);
+
+        result.coefficientsPerMicrosecond = getCoefficientsPerMicrosecond(cases, numRepeats, [&]
+        {
+            if (batched)
+            {
+                FastDesign::prewarp<accuracy>(freqs.data(), g.data(), numCases);
+                FastDesign::makePeaksPrewarped<accuracy>(g.data(), qualities.data(), gains.data(),
+                                                         { columns[0].data(), columns[1].data(), columns[2].data(),
+                                                           columns[3].data(), columns[4].data(), columns[5].data() },
+                                                         numCases);
+                return columns[4][0];
+            }
+
+            auto sum = 0.f;
+
+            for (int i = 0; i < numCases; ++i)
+                sum += FastDesign::makePeak<accuracy>(freqs[(size_t) i], qualities[(size_t) i], gains[(size_t) i]).m1;
+
+            return sum;
+        });
+
+        result.maxPeakErrorDecibels = getMaxResponseError(cases,
+            [](const DesignCase& c, double f) { return getSVFMagnitude(FastDesign::makePeak<accuracy>(c.normalisedFreq, c.quality, c.gainInDecibels), f); },
+            [](const DesignCase& c, double f) { return getSVFMagnitude(makePeakSVF(48000.0, c.normalisedFreq * 48000.f, c.quality, c.gainInDecibels), f); });
+
+        auto lowShelfError = getMaxResponseError(cases,
+            [](const DesignCase& c, double f) { return getSVFMagnitude(FastDesign::makeLowShelf<accuracy>(c.normalisedFreq, c.quality, c.gainInDecibels), f); },
+            [](const DesignCase& c, double f) { return getSVFMagnitude(FastDesign::makeLowShelf<Accuracy::exact>(c.normalisedFreq, c.quality, c.gainInDecibels), f); });
+
+        auto highShelfError = getMaxResponseError(cases,
+            [](const DesignCase& c, double f) { return getSVFMagnitude(FastDesign::makeHighShelf<accuracy>(c.normalisedFreq, c.quality, c.gainInDecibels), f); },
+            [](const DesignCase& c, double f) { return getSVFMagnitude(FastDesign::makeHighShelf<Accuracy::exact>(c.normalisedFreq, c.quality, c.gainInDecibels), f); });
+
+        result.maxShelfErrorDecibels = juce::jmax(lowShelfError, highShelfError);
+        return result;
+    }
+
+    // Measures a tier against tan and 10^x in double precision over the documented range, and
+    // says so if it's outside its bounds
+    template <FastDesign::Accuracy accuracy>
+    bool checkFastDesignBounds(const char* name)
+    {
+        constexpr int numSteps = 49000;
+        double prewarpError = 0.0, amplitudeError = 0.0;
+
+        for (int i = 1; i <= numSteps; ++i)
+        {
+            auto f = FastDesign::maxNormalisedFrequency * (float) i / (float) numSteps;
+            auto exact = std::tan(juce::MathConstants<double>::pi * (double) f);
+
+            prewarpError = juce::jmax(prewarpError, std::abs(FastDesign::prewarp<accuracy>(f) / exact - 1.0));
+        }
+
+        for (int i = -numSteps; i <= numSteps; ++i)
+        {
+            auto decibels = FastDesign::maxGainInDecibels * (float) i / (float) numSteps;
+
+            for (auto divisor : { 40.f, 80.f })
+            {
+                auto exact = std::pow(10.0, (double) decibels / divisor);
+                auto ratio = FastDesign::decibelsToAmplitude<accuracy>(decibels, divisor) / exact;
+
+                amplitudeError = juce::jmax(amplitudeError, std::abs(20.0 * std::log10(ratio)));
+            }
+        }
+
+        auto bounds = FastDesign::getErrorBounds(accuracy);
+
+        if (prewarpError <= bounds.prewarpRelative && amplitudeError <= bounds.amplitudeDecibels)
+            return true;
+
+        std::cerr << "FastDesign " << name << " tier out of bounds: g error " << prewarpError
+                  << " (bound " << bounds.prewarpRelative << "), amplitude error " << amplitudeError
+                  << " dB (bound " << bounds.amplitudeDecibels << " dB)" << std::endl;
+        return false;
+    }
+
+    // JUCE's heap-allocating designer, for comparison
+    DesignResult runJuceDesign(const std::vector<DesignCase>& cases, int numRepeats)
+    {
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+        auto design = [](const DesignCase& c)
+        {
+            return Coefficients::makePeakFilter(48000.0, c.normalisedFreq * 48000.f, c.quality,
+                                                juce::Decibels::decibelsToGain(c.gainInDecibels));
+        };
+
+        DesignResult result;
+
+        result.coefficientsPerMicrosecond = getCoefficientsPerMicrosecond(cases, numRepeats, [&]
+        {
+            auto sum = 0.f;
+
+            for (const auto& designCase : cases)
+                sum += design(designCase)->getRawCoefficients()[0];
+
+            return sum;
+        });
+
+        result.maxPeakErrorDecibels = getMaxResponseError(cases,
+            [&design](const DesignCase& c, double f) { return design(c)->getMagnitudeForFrequency(f * 48000.0, 48000.0); },
+            [](const DesignCase& c, double f) { return getSVFMagnitude(makePeakSVF(48000.0, c.normalisedFreq * 48000.f, c.quality, c.gainInDecibels), f); });
+
+        return result;
+    }
+
+    DesignResult runExactDesign(const std::vector<DesignCase>& cases, int numRepeats)
+    {
+        DesignResult result;
+
+        result.coefficientsPerMicrosecond = getCoefficientsPerMicrosecond(cases, numRepeats, [&]
+        {
+            auto sum = 0.f;
+
+            for (const auto& designCase : cases)
+                sum += makePeakSVF(48000.0, designCase.normalisedFreq * 48000.f, designCase.quality, designCase.gainInDecibels).m1;
+
+            return sum;
+        });
+
+        return result;
+    }
+
+    //==============================================================================
+    class Report
+    {
+    public:
+        explicit Report(bool asCsv) : csv(asCsv)
+        {
+            if (csv)
+                std::cout << "sweep,engine,sample_rate,block_size,channels,bands,automation,"
+                             "ns_per_sample,cycles_per_sample,allocations,worst_block_us,worst_block_load" << std::endl;
+        }
+
+        void beginSweep(const juce::String& name)
+        {
+            sweep = name;
+
+            if (csv)
+                return;
+
+            std::cout << std::endl << "== " << name << " ==" << std::endl
+                      << juce::String("engine").paddedRight(' ', 22)
+                      << juce::String("rate").paddedLeft(' ', 8)
+                      << juce::String("block").paddedLeft(' ', 7)
+                      << juce::String("ch").paddedLeft(' ', 4)
+                      << juce::String("bands").paddedLeft(' ', 7)
+                      << juce::String("automation").paddedLeft(' ', 12)
+                      << juce::String("ns/smp").paddedLeft(' ', 10)
+                      << juce::String("cyc/smp").paddedLeft(' ', 10)
+                      << juce::String("allocs").paddedLeft(' ', 8)
+                      << juce::String("worst us").paddedLeft(' ', 11)
+                      << juce::String("load %").paddedLeft(' ', 9) << std::endl;
+        }
+
+        void add(const RunConfig& config, const RunResult& result)
+        {
+            if (csv)
+            {
+                std::cout << sweep << ',' << config.engine << ',' << config.sampleRate << ',' << config.blockSize << ','
+                          << config.numChannels << ',' << config.numBands << ',' << getAutomationName(config.automation) << ','
+                          << result.nsPerSample << ',' << result.cyclesPerSample << ',' << result.numAllocations << ','
+                          << result.worstBlockMicroseconds << ',' << result.worstBlockLoad << std::endl;
+                return;
+            }
+
+            std::cout << config.engine.paddedRight(' ', 22)
+                      << juce::String(config.sampleRate, 0).paddedLeft(' ', 8)
+                      << juce::String(config.blockSize).paddedLeft(' ', 7)
+                      << juce::String(config.numChannels).paddedLeft(' ', 4)
+                      << juce::String(config.numBands).paddedLeft(' ', 7)
+                      << juce::String(getAutomationName(config.automation)).paddedLeft(' ', 12)
+                      << juce::String(result.nsPerSample, 2).paddedLeft(' ', 10)
+                      << juce::String(result.cyclesPerSample, 1).paddedLeft(' ', 10)
+                      << juce::String(result.numAllocations).paddedLeft(' ', 8)
+                      << juce::String(result.worstBlockMicroseconds, 1).paddedLeft(' ', 11)
+                      << juce::String(result.worstBlockLoad * 100.0, 2).paddedLeft(' ', 9) << std::endl;
+        }
+
+        void beginMorphSweep()
+        {
+            if (csv)
+            {
+                std::cout << "sweep,bands,block_size,update_ns_per_block,glide_ns_per_sample,jumps_ns_per_sample,"
+                             "allocations" << std::endl;
+                return;
+            }
+
+            std::cout << std::endl << "== Snapshot morph (engine only) ==" << std::endl
+                      << juce::String("bands").paddedLeft(' ', 7)
+                      << juce::String("block").paddedLeft(' ', 7)
+                      << juce::String("update ns/blk").paddedLeft(' ', 15)
+                      << juce::String("glide ns/smp").paddedLeft(' ', 14)
+                      << juce::String("jumps ns/smp").paddedLeft(' ', 14)
+                      << juce::String("allocs").paddedLeft(' ', 8) << std::endl;
+        }
+
+        void addMorph(const RunConfig& config, const MorphResult& result)
+        {
+            auto numAllocations = result.glide.numAllocations + result.jumps.numAllocations;
+
+            if (csv)
+            {
+                std::cout << "Snapshot morph," << config.numBands << ',' << config.blockSize << ',' << result.updateNsPerBlock << ','
+                          << result.glide.nsPerSample << ',' << result.jumps.nsPerSample << ',' << numAllocations << std::endl;
+                return;
+            }
+
+            std::cout << juce::String(config.numBands).paddedLeft(' ', 7)
+                      << juce::String(config.blockSize).paddedLeft(' ', 7)
+                      << juce::String(result.updateNsPerBlock, 1).paddedLeft(' ', 15)
+                      << juce::String(result.glide.nsPerSample, 2).paddedLeft(' ', 14)
+                      << juce::String(result.jumps.nsPerSample, 2).paddedLeft(' ', 14)
+                      << juce::String(numAllocations).paddedLeft(' ', 8) << std::endl;
+        }
+
+        void beginStateSweep()
+        {
+            if (csv)
+            {
+                std::cout << "sweep,bands,binary_bytes,xml_bytes,binary_write_us,binary_read_us,"
+                             "xml_write_us,xml_read_us,binary_read_500_instances_ms" << std::endl;
+                return;
+            }
+
+            std::cout << std::endl << "== State save and restore ==" << std::endl
+                      << juce::String("bands").paddedLeft(' ', 7)
+                      << juce::String("bin bytes").paddedLeft(' ', 11)
+                      << juce::String("xml bytes").paddedLeft(' ', 11)
+                      << juce::String("bin save us").paddedLeft(' ', 13)
+                      << juce::String("bin load us").paddedLeft(' ', 13)
+                      << juce::String("xml save us").paddedLeft(' ', 13)
+                      << juce::String("xml load us").paddedLeft(' ', 13)
+                      << juce::String("500 loads ms").paddedLeft(' ', 14) << std::endl;
+        }
+
+        void addState(int numBands, const StateResult& result)
+        {
+            auto fiveHundredLoadsMs = result.binaryReadUs * 500.0 * 1.0e-3;
+
+            if (csv)
+            {
+                std::cout << "State," << numBands << ',' << result.binaryBytes << ',' << result.xmlBytes << ','
+                          << result.binaryWriteUs << ',' << result.binaryReadUs << ',' << result.xmlWriteUs << ','
+                          << result.xmlReadUs << ',' << fiveHundredLoadsMs << std::endl;
+                return;
+            }
+
+            std::cout << juce::String(numBands).paddedLeft(' ', 7)
+                      << juce::String((juce::int64) result.binaryBytes).paddedLeft(' ', 11)
+                      << juce::String((juce::int64) result.xmlBytes).paddedLeft(' ', 11)
+                      << juce::String(result.binaryWriteUs, 2).paddedLeft(' ', 13)
+                      << juce::String(result.binaryReadUs, 2).paddedLeft(' ', 13)
+                      << juce::String(result.xmlWriteUs, 2).paddedLeft(' ', 13)
+                      << juce::String(result.xmlReadUs, 2).paddedLeft(' ', 13)
+                      << juce::String(fiveHundredLoadsMs, 2).paddedLeft(' ', 14) << std::endl;
+        }
+
+        void beginDesignSweep()
+        {
+            if (csv)
+            {
+                std::cout << "sweep,designer,coefficients_per_us,max_peak_error_db,max_shelf_error_db" << std::endl;
+                return;
+            }
+
+            std::cout << std::endl << "== Coefficient design ==" << std::endl
+                      << juce::String("designer").paddedRight(' ', 26)
+                      << juce::String("coeffs/us").paddedLeft(' ', 11)
+                      << juce::String("bell err dB").paddedLeft(' ', 13)
+                      << juce::String("shelf err dB").paddedLeft(' ', 14) << std::endl;
+        }
+
+        void addDesign(const juce::String& designer, const DesignResult& result)
+        {
+            auto shelfError = result.maxShelfErrorDecibels.has_value() ? juce::String(*result.maxShelfErrorDecibels, 6)
+                                                                       : juce::String("-");
+
+            if (csv)
+            {
+                std::cout << "Design," << designer << ',' << result.coefficientsPerMicrosecond << ','
+                          << result.maxPeakErrorDecibels << ',' << shelfError << std::endl;
+                return;
+            }
+
+            std::cout << designer.paddedRight(' ', 26)
+                      << juce::String(result.coefficientsPerMicrosecond, 1).paddedLeft(' ', 11)
+                      << juce::String(result.maxPeakErrorDecibels, 6).paddedLeft(' ', 13)
+                      << shelfError.paddedLeft(' ', 14) << std::endl;
+        }
+
+        void beginNoiseFloorSweep()
+        {
+            if (csv)
+            {
+                std::cout << "sweep,sample_rate,float_noise_floor_db,double_noise_floor_db" << std::endl;
+                return;
+            }
+
+            std::cout << std::endl << "== Noise floor, " << numNoiseFloorBands << " bands at 20-40 Hz, Q 10 ==" << std::endl
+                      << juce::String("rate").paddedLeft(' ', 8)
+                      << juce::String("float dB").paddedLeft(' ', 12)
+                      << juce::String("double dB").paddedLeft(' ', 12) << std::endl;
+        }
+
+        void addNoiseFloor(double sampleRate, double floatDecibels, double doubleDecibels)
+        {
+            if (csv)
+            {
+                std::cout << "Noise floor," << sampleRate << ',' << floatDecibels << ',' << doubleDecibels << std::endl;
+                return;
+            }
+
+            std::cout << juce::String(sampleRate, 0).paddedLeft(' ', 8)
+                      << juce::String(floatDecibels, 1).paddedLeft(' ', 12)
+                      << juce::String(doubleDecibels, 1).paddedLeft(' ', 12) << std::endl;
+        }
+
+    private:
+        bool csv;
+        juce::String sweep;
+    };
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    static_assert(AllocationTripwire::isEnabled, "The benchmark counts allocations through the tripwire");
+    AllocationTripwire::setAssertOnAllocation(false);
+
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto quick = args.contains("--quick");
+    Report report(args.contains("--csv"));
+
+    auto seconds = quick ? 0.25 : 2.0;
+    const RunConfig baseline;
+
+    auto runProcessorSweep = [&](const juce::String& name, auto&& configs)
+    {
+        report.beginSweep(name);
+
+        for (const auto& config : configs)
+            report.add(config, runProcessor(config, seconds));
+    };
+
+    auto blockSizes = quick ? std::vector<int>{ 16, 512, 4096 }
+                            : std::vector<int>{ 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+    std::vector<RunConfig> configs;
+
+    for (auto blockSize : blockSizes)
+    {
+        auto config = baseline;
+        config.blockSize = blockSize;
+        configs.push_back(config);
+    }
+
+    runProcessorSweep("Block size", configs);
+
+    configs.clear();
+
+    for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+    {
+        auto config = baseline;
+        config.sampleRate = sampleRate;
+        configs.push_back(config);
+    }
+
+    runProcessorSweep("Sample rate", configs);
+
+    configs.clear();
+
+    // Mono, stereo, 5.1 and 7.1.4: the cost per channel should stay flat
+    for (auto numChannels : { 1, 2, 6, 12 })
+    {
+        auto config = baseline;
+        config.numChannels = numChannels;
+        configs.push_back(config);
+    }
+
+    runProcessorSweep("Channel count", configs);
+
+    configs.clear();
+
+    for (auto blockSize : { 64, 512 })
+    {
+        for (auto automation : { Automation::none, Automation::perBlock, Automation::perSample })
+        {
+            auto config = baseline;
+            config.blockSize = blockSize;
+            config.automation = automation;
+            configs.push_back(config);
+        }
+    }
+
+    runProcessorSweep("Automation density", configs);
+
+    configs.clear();
+
+    for (auto* engine : { "IIR", "IIR 2x", "IIR 4x", "IIR 8x", "IIR 2x FIR", "IIR 4x FIR", "IIR 8x FIR",
+                          "Linear 1024", "Linear 4096", "Linear 16384" })
+    {
+        auto config = baseline;
+        config.engine = engine;
+        configs.push_back(config);
+    }
+
+    runProcessorSweep("Engine and oversampling", configs);
+
+    // The processor's band count is fixed at build time, so the band count sweeps drive the engine directly
+    report.beginSweep("Band count x kernel (engine only)");
+
+    for (auto numChannels : { 2, 8 })
+    {
+        for (auto numBands : { 1, 4, 8, 16, 32, 64 })
+        {
+            for (auto type : { Cascade::KernelType::scalar, Cascade::KernelType::sse,
+                               Cascade::KernelType::avx, Cascade::KernelType::neon })
+            {
+                if (! Cascade::isSupported(type))
+                    continue;
+
+                auto config = baseline;
+                config.engine = juce::String("Engine ") + Cascade::getKernelName(type);
+                config.numChannels = numChannels;
+                config.numBands = numBands;
+                report.add(config, runEngine(config, seconds, type));
+            }
+        }
+    }
+
+    report.beginSweep("Control interval, per-block automation (engine only)");
+
+    for (auto controlInterval : { 1, 4, 16, 64 })
+    {
+        auto config = baseline;
+        config.engine = "Engine interval " + juce::String(controlInterval);
+        config.automation = Automation::perBlock;
+        report.add(config, runEngine(config, seconds, {}, controlInterval));
+    }
+
+    // Dynamic bands redesign every control tick, so this is the worst case for coefficient updates
+    report.beginSweep("Dynamic bands, 64-sample blocks (engine only)");
+
+    for (auto numBands : { 4, 16, 32, 64 })
+    {
+        for (auto dynamicBands : { false, true })
+        {
+            auto config = baseline;
+            config.engine = dynamicBands ? "Engine dynamic" : "Engine static";
+            config.blockSize = 64;
+            config.numBands = numBands;
+            config.dynamicBands = dynamicBands;
+            report.add(config, runEngine(config, seconds));
+        }
+    }
+
+    // Placed bands and per-channel detectors against the linked engine, across layouts
+    report.beginSweep("Channel layout x mode, 16 dynamic bands (engine only)");
+
+    for (auto numChannels : { 1, 2, 6, 12 })
+    {
+        for (auto channelMode : { FeatherParameters::linked, FeatherParameters::independent, FeatherParameters::midSide })
+        {
+            auto config = baseline;
+            config.engine = juce::StringArray{ "Engine linked", "Engine independent", "Engine mid/side" }[channelMode];
+            config.numChannels = numChannels;
+            config.numBands = 16;
+            config.dynamicBands = true;
+            config.channelMode = channelMode;
+            report.add(config, runEngine(config, seconds));
+        }
+    }
+
+    // Each slope adds its sections to both cuts; off should cost nothing over the bands alone
+    report.beginSweep("Cut slope, both cuts (engine only)");
+
+    for (int slope = 0; slope < FeatherParameters::numCutSlopes; ++slope)
+    {
+        auto config = baseline;
+        config.engine = "Engine cut " + FeatherParameters::getCutSlopeNames()[slope];
+        config.cutSlope = slope;
+        report.add(config, runEngine(config, seconds));
+    }
+
+    // An idle instance should cost next to nothing once its tail has run out
+    configs.clear();
+
+    for (auto* engine : { "IIR", "IIR 4x", "Linear 4096" })
+    {
+        for (auto silentInput : { false, true })
+        {
+            auto config = baseline;
+            config.engine = engine;
+            config.silentInput = silentInput;
+            configs.push_back(config);
+        }
+    }
+
+    report.beginSweep("Noise x silent input");
+
+    for (auto config : configs)
+    {
+        auto result = runProcessor(config, seconds);
+        config.engine << (config.silentInput ? " silent" : " noise");
+        report.add(config, result);
+    }
+
+    // Same work in each precision; the double kernels have half the lanes per register
+    report.beginSweep("Float x double precision");
+
+    for (auto* engine : { "IIR", "IIR 4x", "Linear 4096" })
+    {
+        for (auto doublePrecision : { false, true })
+        {
+            auto config = baseline;
+            config.engine = engine;
+            config.doublePrecision = doublePrecision;
+            auto result = runProcessor(config, seconds);
+
+            config.engine << (doublePrecision ? " double" : " float");
+            report.add(config, result);
+        }
+    }
+
+    for (auto numBands : { 4, 16, 64 })
+    {
+        for (auto doublePrecision : { false, true })
+        {
+            auto config = baseline;
+            config.engine = doublePrecision ? "Engine double" : "Engine float";
+            config.numBands = numBands;
+            config.doublePrecision = doublePrecision;
+            report.add(config, runEngine(config, seconds));
+        }
+    }
+
+    report.beginNoiseFloorSweep();
+
+    for (auto sampleRate : { 48000.0, 96000.0, 192000.0 })
+        report.addNoiseFloor(sampleRate, measureNoiseFloorDecibels<float>(sampleRate, seconds),
+                             measureNoiseFloorDecibels<double>(sampleRate, seconds));
+
+    report.beginMorphSweep();
+
+    for (auto numBands : { 4, 16, 64 })
+    {
+        for (auto blockSize : { 64, 512 })
+        {
+            auto config = baseline;
+            config.numBands = numBands;
+            config.blockSize = blockSize;
+            report.addMorph(config, runMorph(config, seconds));
+        }
+    }
+
+    report.beginStateSweep();
+
+    for (auto numBands : { 4, 16, 64, 256 })
+        report.addState(numBands, runState(numBands, quick ? 50 : 1000));
+
+    auto boundsHeld = true;
+
+    {
+        using FastDesign::Accuracy;
+
+        // Every tier is checked, so a failure reports all the tiers that are out
+        boundsHeld = checkFastDesignBounds<Accuracy::exact>("exact") && boundsHeld;
+        boundsHeld = checkFastDesignBounds<Accuracy::high>("high") && boundsHeld;
+        boundsHeld = checkFastDesignBounds<Accuracy::fast>("fast") && boundsHeld;
+        jassert(boundsHeld);
+
+        auto cases = getDesignCases();
+        auto numRepeats = quick ? 20 : 500;
+
+        report.beginDesignSweep();
+        report.addDesign("JUCE makePeakFilter", runJuceDesign(cases, numRepeats));
+        report.addDesign("makePeakSVF", runExactDesign(cases, numRepeats));
+        report.addDesign("Fast exact", runFastDesign<Accuracy::exact>(cases, numRepeats, false));
+        report.addDesign("Fast high", runFastDesign<Accuracy::high>(cases, numRepeats, false));
+        report.addDesign("Fast fast", runFastDesign<Accuracy::fast>(cases, numRepeats, false));
+        report.addDesign("Fast high, batched", runFastDesign<Accuracy::high>(cases, numRepeats, true));
+        report.addDesign("Fast fast, batched", runFastDesign<Accuracy::fast>(cases, numRepeats, true));
+    }
+
+    return boundsHeld ? 0 : 1;
+}
@@ -0,0 +1,649 @@
+/*
+  ==============================================================================
+
+    GraphRunnerMain.cpp
+
+    Headless runner for AudioPluginHost .filtergraph files, such as the
+    bundled "Diva EQ Test.filtergraph". Builds the graph's audio nodes and
+    connections, renders a fixed test signal through them offline, writes
+    what reaches the Audio Output node to a WAV file, and reports per-node
+    timing and the end-to-end latency.
+
+    Nodes are built from what the graph says about them:
+
+      this plugin (by name)         the plugin processor, with the state the
+                                    host saved for it
+      Audio Input, instruments      the test signal: a log sine sweep from
+                                    20 Hz to 20 kHz at -12 dBFS, worked out
+                                    from the sample index, so every run and
+                                    block size gives the same audio
+      any other plugin              a pass-through stand-in
+      Audio Output                  the rendered file
+
+    MIDI nodes and MIDI connections are left out; nothing here plays notes.
+
+    The graph is split into levels, each node one level after the deepest
+    of its inputs. Nodes in a level don't depend on each other, so each
+    block runs a level's nodes in parallel on a thread pool, one level
+    after another. Per node, the report gives the mean and worst time per
+    block, also as a fraction of the block's real-time duration, and the
+    latency from the graph's sources to it.
+
+    Usage: FeatheringGraphRunner <graph> [--output <file.wav>] [--seconds <n>]
+                                 [--rate <hz>] [--block <samples>] [--threads <n>]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "AllocationTripwire.h"
+
+#include <cstring>
+#include <map>
+
+namespace
+{
+    //==============================================================================
+    struct Options
+    {
+        juce::File graphFile, outputFile;
+        double seconds{ 10.0 };
+        double sampleRate{ 48000.0 };
+        int blockSize{ 512 };
+        int numThreads{ juce::SystemStats::getNumCpus() };
+    };
+
+    void printUsage()
+    {
+        std::cerr << "Usage: FeatheringGraphRunner <graph> [--output <file.wav>] [--seconds <n>]\n"
+                     "                             [--rate <hz>] [--block <samples>] [--threads <n>]" << std::endl;
+    }
+
+    std::optional<Options> parseOptions(const juce::StringArray& args)
+    {
+        Options options;
+        auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            auto hasValue = i + 1 < args.size();
+
+            if (arg == "--output" && hasValue)
+                options.outputFile = cwd.getChildFile(args[++i]);
+            else if (arg == "--seconds" && hasValue)
+                options.seconds = args[++i].getDoubleValue();
+            else if (arg == "--rate" && hasValue)
+                options.sampleRate = args[++i].getDoubleValue();
+            else if (arg == "--block" && hasValue)
+                options.blockSize = args[++i].getIntValue();
+            else if (arg == "--threads" && hasValue)
+                options.numThreads = args[++i].getIntValue();
+            else if (arg.startsWith("--") || options.graphFile != juce::File())
+                return {};
+            else
+                options.graphFile = cwd.getChildFile(arg);
+        }
+
+        if (options.graphFile == juce::File() || options.seconds <= 0.0 || options.sampleRate <= 0.0
+             || options.blockSize < 1 || options.numThreads < 1)
+            return {};
+
+        if (options.outputFile == juce::File())
+            options.outputFile = cwd.getChildFile(options.graphFile.getFileNameWithoutExtension() + ".wav");
+
+        return options;
+    }
+
+    //==============================================================================
+    // The test signal, the same on every channel
+    class TestSignal
+    {
+    public:
+        TestSignal(double sampleRateToUse, juce::int64 lengthInSamples)
+            : sampleRate(sampleRateToUse), duration((double) lengthInSamples / sampleRateToUse)
+        {
+        }
+
+        float getSample(juce::int64 index) const noexcept
+        {
+            // Exponential sweep: the phase integrates f(t) = startFreq * (endFreq / startFreq)^(t / duration)
+            constexpr double startFreq = 20.0, endFreq = 20000.0, level = 0.25;
+            const auto logRatio = std::log(endFreq / startFreq);
+
+            auto t = (double) index / sampleRate;
+            auto phase = juce::MathConstants<double>::twoPi * startFreq * duration / logRatio * (std::exp(t / duration * logRatio) - 1.0);
+
+            return (float) (level * std::sin(phase));
+        }
+
+    private:
+        double sampleRate, duration;
+    };
+
+    //==============================================================================
+    struct Connection
+    {
+        int sourceNode, sourceChannel, destChannel;
+    };
+
+    // A node processes in place on its own buffer, as a plugin does: inputs are summed into
+    // the first channels, and its outputs are left in the first channels for the nodes after it.
+    class Node
+    {
+    public:
+        Node(int uidToUse, const juce::String& nameToUse, int numInputsToUse, int numOutputsToUse)
+            : uid(uidToUse), name(nameToUse), numInputs(numInputsToUse), numOutputs(numOutputsToUse)
+        {
+        }
+
+        virtual ~Node() = default;
+
+        virtual bool prepare(double sampleRate, int blockSize)
+        {
+            juce::ignoreUnused(sampleRate);
+            buffer.setSize(juce::jmax(numInputs, numOutputs), blockSize);
+            return true;
+        }
+
+        virtual void process(juce::AudioBuffer<float>& block, juce::int64 position) = 0;
+        virtual int getLatencySamples() const  { return 0; }
+        virtual juce::String getKind() const = 0;
+
+        // Sums the connected outputs of earlier nodes into the inputs, then processes, timed
+        void run(int numSamples, juce::int64 position, const std::vector<std::unique_ptr<Node>>& nodes)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+            block.clear();
+
+            for (const auto& connection : inputs)
+                block.addFrom(connection.destChannel, 0, nodes[(size_t) connection.sourceNode]->buffer, connection.sourceChannel, 0, numSamples);
+
+            process(block, position);
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            totalSeconds += seconds;
+            worstSeconds = juce::jmax(worstSeconds, seconds);
+            ++numBlocks;
+        }
+
+        const int uid;
+        const juce::String name;
+        const int numInputs, numOutputs;
+
+        std::vector<Connection> inputs;
+        juce::AudioBuffer<float> buffer;
+
+        int level{ 0 };
+        int pathLatency{ 0 };   // from the sources up to and including this node
+
+        double totalSeconds{ 0.0 }, worstSeconds{ 0.0 };
+        juce::int64 numBlocks{ 0 };
+    };
+
+    class SignalNode  : public Node
+    {
+    public:
+        SignalNode(int uidToUse, const juce::String& nameToUse, int numOutputsToUse, const TestSignal& signalToUse)
+            : Node(uidToUse, nameToUse, 0, numOutputsToUse), signal(signalToUse)
+        {
+        }
+
+        void process(juce::AudioBuffer<float>& block, juce::int64 position) override
+        {
+            for (int i = 0; i < block.getNumSamples(); ++i)
+            {
+                auto sample = signal.getSample(position + i);
+
+                for (int channel = 0; channel < numOutputs; ++channel)
+                    block.setSample(channel, i, sample);
+            }
+        }
+
+        juce::String getKind() const override  { return "test signal"; }
+
+    private:
+        const TestSignal& signal;
+    };
+
+    class PassThroughNode  : public Node
+    {
+    public:
+        PassThroughNode(int uidToUse, const juce::String& nameToUse, int numInputsToUse, int numOutputsToUse, juce::String kindToUse)
+            : Node(uidToUse, nameToUse, numInputsToUse, numOutputsToUse), kind(std::move(kindToUse))
+        {
+        }
+
+        void process(juce::AudioBuffer<float>& block, juce::int64) override
+        {
+            // Outputs with no input to pass on are silent
+            for (int channel = numInputs; channel < numOutputs; ++channel)
+                block.clear(channel, 0, block.getNumSamples());
+        }
+
+        juce::String getKind() const override  { return kind; }
+
+    private:
+        juce::String kind;
+    };
+
+    class PluginNode  : public Node
+    {
+    public:
+        PluginNode(int uidToUse, const juce::String& nameToUse, int numInputsToUse, int numOutputsToUse, const juce::MemoryBlock& state)
+            : Node(uidToUse, nameToUse, numInputsToUse, numOutputsToUse)
+        {
+            processor.setNonRealtime(true);
+
+            if (! state.isEmpty())
+                processor.setStateInformation(state.getData(), (int) state.getSize());
+        }
+
+        bool prepare(double sampleRate, int blockSize) override
+        {
+            juce::AudioProcessor::BusesLayout layout;
+            layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numInputs));
+            layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numOutputs));
+
+            if (! processor.setBusesLayout(layout))
+                return false;
+
+            Node::prepare(sampleRate, blockSize);
+
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            waitForKernel(sampleRate);
+            processor.reset();
+            return true;
+        }
+
+        void process(juce::AudioBuffer<float>& block, juce::int64) override
+        {
+            processor.processBlock(block, midi);
+        }
+
+        int getLatencySamples() const override  { return processor.getLatencySamples(); }
+
+        juce::String getKind() const override  { return "plugin"; }
+
+    private:
+        // As in the batch renderer: quiet noise until the linear-phase kernel is in and has faded in
+        void waitForKernel(double sampleRate)
+        {
+            constexpr double timeoutMs = 10000.0, crossfadeSeconds = 0.1;
+            constexpr float noiseLevel = 1.0e-4f;
+
+            juce::Random random;
+            auto deadline = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+            auto waited = false;
+
+            auto processNoise = [&]
+            {
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    for (int i = 0; i < buffer.getNumSamples(); ++i)
+                        buffer.setSample(channel, i, noiseLevel * (2.f * random.nextFloat() - 1.f));
+
+                processor.processBlock(buffer, midi);
+            };
+
+            while (processor.isWaitingForKernel())
+            {
+                if (juce::Time::getMillisecondCounterHiRes() > deadline)
+                {
+                    std::cerr << "Timed out waiting for the linear-phase kernel" << std::endl;
+                    return;
+                }
+
+                waited = true;
+                processNoise();
+                juce::Thread::sleep(5);
+            }
+
+            if (waited)
+                for (int done = 0; done < juce::roundToInt(crossfadeSeconds * sampleRate); done += buffer.getNumSamples())
+                    processNoise();
+        }
+
+        FeatheringIdeaStartAudioProcessor processor;
+        juce::MidiBuffer midi;
+    };
+
+    //==============================================================================
+    // The host saves a VST3's state as "VC2!", a size and XML holding the component state, and
+    // the JUCE wrapper appends its own private data to that. Anything else is the state as is.
+    juce::MemoryBlock extractPluginState(const juce::String& savedState)
+    {
+        juce::MemoryBlock state;
+
+        if (! state.fromBase64Encoding(savedState) || state.getSize() < 8 || std::memcmp(state.getData(), "VC2!", 4) != 0)
+            return state;
+
+        auto xmlSize = (int) juce::ByteOrder::littleEndianInt(static_cast<const char*>(state.getData()) + 4);
+        auto xml = juce::parseXML(juce::String::fromUTF8(static_cast<const char*>(state.getData()) + 8,
+                                                         juce::jmin(xmlSize, (int) state.getSize() - 8)));
+
+        juce::MemoryBlock component;
+
+        if (xml == nullptr || ! component.fromBase64Encoding(xml->getChildElementAllSubText("IComponent", {})))
+            return {};
+
+        // [plugin state] [int64] ["JUCEPrivateData\0" + private data, size bytes] [int64 size] ["JUCEPrivateData"]
+        constexpr const char* privateDataID = "JUCEPrivateData";
+        const auto idLength = (size_t) std::strlen(privateDataID);
+        const auto* bytes = static_cast<const char*>(component.getData());
+        auto size = component.getSize();
+
+        if (size >= idLength + 8 && std::memcmp(bytes + size - idLength, privateDataID, idLength) == 0)
+        {
+            auto privateSize = (size_t) juce::ByteOrder::littleEndianInt64(bytes + size - idLength - 8);
+            auto trailerSize = idLength + 8 + privateSize + 8;
+
+            component.setSize(size >= trailerSize ? size - trailerSize : 0);
+        }
+
+        return component;
+    }
+
+    struct Graph
+    {
+        std::vector<std::unique_ptr<Node>> nodes;   // in level order
+        std::vector<std::vector<Node*>> levels;
+        std::vector<Node*> outputs;
+    };
+
+    std::optional<Graph> loadGraph(const juce::File& file, const TestSignal& signal)
+    {
+        auto xml = juce::parseXML(file);
+
+        if (xml == nullptr || ! xml->hasTagName("FILTERGRAPH"))
+        {
+            std::cerr << "Not a filter graph: " << file.getFullPathName() << std::endl;
+            return {};
+        }
+
+        Graph graph;
+        std::map<int, int> nodeIndices;
+
+        for (auto* filter : xml->getChildWithTagNameIterator("FILTER"))
+        {
+            auto* plugin = filter->getChildByName("PLUGIN");
+
+            if (plugin == nullptr)
+                continue;
+
+            auto uid = filter->getIntAttribute("uid");
+            auto name = plugin->getStringAttribute("name");
+            auto numInputs = plugin->getIntAttribute("numInputs");
+            auto numOutputs = plugin->getIntAttribute("numOutputs");
+            auto internal = plugin->getStringAttribute("format") == "Internal";
+
+            std::unique_ptr<Node> node;
+            auto isOutput = internal && name == "Audio Output";
+
+            if (internal && name == "Audio Input")
+                node = std::make_unique<SignalNode>(uid, name, numOutputs, signal);
+            else if (isOutput)
+                node = std::make_unique<PassThroughNode>(uid, name, numInputs, 0, "output");
+            else if (internal)
+                continue;   // MIDI I/O
+            else if (name == JucePlugin_Name)
+                node = std::make_unique<PluginNode>(uid, name, numInputs, numOutputs,
+                                                    extractPluginState(filter->getChildElementAllSubText("STATE", {}).trim()));
+            else if (plugin->getBoolAttribute("isInstrument") || numInputs == 0)
+                node = std::make_unique<SignalNode>(uid, name, numOutputs, signal);
+            else
+                node = std::make_unique<PassThroughNode>(uid, name, numInputs, numOutputs, "stand-in");
+
+            if (isOutput)
+                graph.outputs.push_back(node.get());
+
+            nodeIndices[uid] = (int) graph.nodes.size();
+            graph.nodes.push_back(std::move(node));
+        }
+
+        for (auto* connection : xml->getChildWithTagNameIterator("CONNECTION"))
+        {
+            auto source = nodeIndices.find(connection->getIntAttribute("srcFilter"));
+            auto dest = nodeIndices.find(connection->getIntAttribute("dstFilter"));
+            auto sourceChannel = connection->getIntAttribute("srcChannel");
+            auto destChannel = connection->getIntAttribute("dstChannel");
+
+            // MIDI connections, and any to a node that was left out
+            if (source == nodeIndices.end() || dest == nodeIndices.end() || sourceChannel == juce::AudioProcessorGraph::midiChannelIndex)
+                continue;
+
+            auto& destNode = *graph.nodes[(size_t) dest->second];
+
+            if (! juce::isPositiveAndBelow(sourceChannel, graph.nodes[(size_t) source->second]->numOutputs)
+                 || ! juce::isPositiveAndBelow(destChannel, destNode.numInputs))
+            {
+                std::cerr << "Skipping a connection to a channel that doesn't exist, into " << destNode.name << std::endl;
+                continue;
+            }
+
+            destNode.inputs.push_back({ source->second, sourceChannel, destChannel });
+        }
+
+        // Levels by Kahn's algorithm: a node is ready once every node feeding it has a level
+        std::vector<int> numPending(graph.nodes.size());
+        std::vector<std::vector<int>> consumers(graph.nodes.size());
+
+        for (size_t i = 0; i < graph.nodes.size(); ++i)
+        {
+            for (const auto& connection : graph.nodes[i]->inputs)
+            {
+                ++numPending[i];
+                consumers[(size_t) connection.sourceNode].push_back((int) i);
+            }
+        }
+
+        std::vector<int> ready;
+
+        for (size_t i = 0; i < graph.nodes.size(); ++i)
+            if (numPending[i] == 0)
+                ready.push_back((int) i);
+
+        size_t numPlaced = 0;
+
+        while (! ready.empty())
+        {
+            std::vector<int> next;
+            graph.levels.emplace_back();
+
+            for (auto index : ready)
+            {
+                auto* node = graph.nodes[(size_t) index].get();
+                node->level = (int) graph.levels.size() - 1;
+                graph.levels.back().push_back(node);
+                ++numPlaced;
+
+                for (auto consumer : consumers[(size_t) index])
+                    if (--numPending[(size_t) consumer] == 0)
+                        next.push_back(consumer);
+            }
+
+            ready = std::move(next);
+        }
+
+        if (numPlaced != graph.nodes.size())
+        {
+            std::cerr << "The graph has a feedback loop" << std::endl;
+            return {};
+        }
+
+        if (graph.outputs.empty())
+        {
+            std::cerr << "The graph has no Audio Output" << std::endl;
+            return {};
+        }
+
+        return graph;
+    }
+
+    //==============================================================================
+    // Runs a level's nodes across the pool, with the calling thread taking the first
+    class LevelRunner
+    {
+    public:
+        explicit LevelRunner(int numThreads)
+            : pool(juce::jmax(1, numThreads - 1))
+        {
+        }
+
+        void run(const std::vector<Node*>& level, int numSamples, juce::int64 position, const Graph& graph)
+        {
+            if (level.size() > 1)
+            {
+                remaining.store((int) level.size() - 1);
+
+                for (size_t i = 1; i < level.size(); ++i)
+                {
+                    pool.addJob([this, node = level[i], numSamples, position, &graph]
+                    {
+                        node->run(numSamples, position, graph.nodes);
+
+                        if (--remaining == 0)
+                            finished.signal();
+                    });
+                }
+            }
+
+            level.front()->run(numSamples, position, graph.nodes);
+
+            if (level.size() > 1)
+                finished.wait();
+        }
+
+    private:
+        juce::ThreadPool pool;
+        std::atomic<int> remaining{ 0 };
+        juce::WaitableEvent finished;
+    };
+
+    //==============================================================================
+    void printReport(const Graph& graph, const Options& options, double wallSeconds)
+    {
+        auto blockSeconds = options.blockSize / options.sampleRate;
+
+        std::cout << "\n" << juce::String("Node").paddedRight(' ', 28) << juce::String("Kind").paddedRight(' ', 13)
+                  << "Level  Latency   Mean us  Worst us   Mean %  Worst %\n";
+
+        for (const auto& node : graph.nodes)
+        {
+            auto meanSeconds = node->numBlocks > 0 ? node->totalSeconds / (double) node->numBlocks : 0.0;
+
+            std::cout << (node->name + " (" + juce::String(node->uid) + ")").paddedRight(' ', 28)
+                      << node->getKind().paddedRight(' ', 13)
+                      << juce::String(node->level).paddedLeft(' ', 5)
+                      << juce::String(node->pathLatency).paddedLeft(' ', 9)
+                      << juce::String(meanSeconds * 1.0e6, 2).paddedLeft(' ', 10)
+                      << juce::String(node->worstSeconds * 1.0e6, 2).paddedLeft(' ', 10)
+                      << juce::String(100.0 * meanSeconds / blockSeconds, 2).paddedLeft(' ', 9)
+                      << juce::String(100.0 * node->worstSeconds / blockSeconds, 2).paddedLeft(' ', 9) << "\n";
+        }
+
+        for (const auto* output : graph.outputs)
+            std::cout << "\nLatency to " << output->name << " (" << output->uid << "): " << output->pathLatency << " samples, "
+                      << juce::String(1000.0 * output->pathLatency / options.sampleRate, 2) << " ms";
+
+        std::cout << "\n" << juce::String(options.seconds, 1) << " s rendered in " << juce::String(wallSeconds, 3) << " s, "
+                  << juce::String(options.seconds / juce::jmax(wallSeconds, 1.0e-9), 1) << "x real time, "
+                  << (int) graph.levels.size() << " levels" << std::endl;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    AllocationTripwire::setAssertOnAllocation(false);
+
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto options = parseOptions(args);
+
+    if (! options.has_value())
+    {
+        printUsage();
+        return 1;
+    }
+
+    auto lengthInSamples = (juce::int64) std::ceil(options->seconds * options->sampleRate);
+    TestSignal signal(options->sampleRate, lengthInSamples);
+
+    auto graph = loadGraph(options->graphFile, signal);
+
+    if (! graph.has_value())
+        return 1;
+
+    for (auto& node : graph->nodes)
+    {
+        if (! node->prepare(options->sampleRate, options->blockSize))
+        {
+            std::cerr << "Can't prepare " << node->name << " with " << node->numInputs << " in and " << node->numOutputs << " out" << std::endl;
+            return 1;
+        }
+    }
+
+    // Latency adds up along the slowest path into each node
+    for (const auto& level : graph->levels)
+    {
+        for (auto* node : level)
+        {
+            auto inputLatency = 0;
+
+            for (const auto& connection : node->inputs)
+                inputLatency = juce::jmax(inputLatency, graph->nodes[(size_t) connection.sourceNode]->pathLatency);
+
+            node->pathLatency = inputLatency + node->getLatencySamples();
+        }
+    }
+
+    // The first Audio Output is the one written out
+    auto* output = graph->outputs.front();
+
+    if (! options->outputFile.getParentDirectory().createDirectory())
+        return 1;
+
+    options->outputFile.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(options->outputFile);
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(stream.get(), options->sampleRate,
+                                                                                          (unsigned int) output->numInputs, 32, {}, 0));
+
+    if (writer == nullptr)
+    {
+        std::cerr << "Can't write " << options->outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    stream.release();
+
+    LevelRunner runner(options->numThreads);
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (juce::int64 position = 0; position < lengthInSamples; position += options->blockSize)
+    {
+        auto numSamples = (int) juce::jmin((juce::int64) options->blockSize, lengthInSamples - position);
+
+        for (const auto& level : graph->levels)
+            runner.run(level, numSamples, position, *graph);
+
+        writer->writeFromAudioSampleBuffer(output->buffer, 0, numSamples);
+    }
+
+    auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+    writer.reset();
+
+    std::cout << "Wrote " << options->outputFile.getFullPathName() << std::endl;
+    printReport(*graph, *options, wallSeconds);
+    return 0;
+}